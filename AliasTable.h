@@ -0,0 +1,119 @@
+#ifndef ALIASTABLE_H
+#define ALIASTABLE_H
+
+#include <vector>
+#include <cstddef>
+#include <cassert>
+#include <iostream>
+#include <cstdlib>
+#include "Checkpoint.h"
+
+/*! @class AliasTable
+
+    @brief O(1) sampling of an index from a discrete distribution.
+
+    Walker's alias method, with Vose's numerically stable construction:
+    Vose 1991 A linear algorithm for generating random numbers with a given
+    distribution.  IEEE Transactions on Software Engineering 17:972-975.
+
+    Construction is O(n) in the number of weights.  Each sample then takes
+    a single uniform draw, which picks a column and, from the fractional
+    part, either that column's index or its alias.
+ */
+class AliasTable {
+
+    private:
+
+        std::vector<double>   Prob;   // probability of keeping column i
+        std::vector<size_t>   Alias;  // index returned otherwise
+        double                _total; // sum of the weights
+
+    public:
+
+        AliasTable() : _total(0.0) { /* empty */ };
+
+        /*! constructor
+
+            @param weights  non-negative weights, not necessarily normalized
+         */
+        AliasTable(const std::vector<double>& weights) : _total(0.0)
+        { build(weights); };
+
+        size_t  size() const  { return(Prob.size()); };
+        double  total() const { return(_total); };
+
+        //! (Re)build the table from a vector of non-negative weights
+        void
+        build(const std::vector<double>& weights)
+        {
+            const size_t n = weights.size();
+            Prob.assign(n, 0.0);
+            Alias.assign(n, 0);
+            _total = 0.0;
+            for (size_t i = 0; i < n; ++i) {
+                if (weights[i] < 0.0) {
+                    std::cerr << "AliasTable::build : negative weight" << std::endl;
+                    exit(1);
+                }
+                _total += weights[i];
+            }
+            if (n == 0 || _total <= 0.0) {
+                std::cerr << "AliasTable::build : no positive weights" << std::endl;
+                exit(1);
+            }
+            std::vector<double> scaled(n);
+            std::vector<size_t> small, large;
+            for (size_t i = 0; i < n; ++i) {
+                scaled[i] = weights[i] * n / _total;
+                if (scaled[i] < 1.0) small.push_back(i);
+                else large.push_back(i);
+            }
+            while (! small.empty() && ! large.empty()) {
+                size_t s = small.back(); small.pop_back();
+                size_t l = large.back();
+                Prob[s] = scaled[s];
+                Alias[s] = l;
+                scaled[l] = (scaled[l] + scaled[s]) - 1.0;
+                if (scaled[l] < 1.0) { large.pop_back(); small.push_back(l); }
+            }
+            // what remains is 1 up to rounding error
+            for (size_t i = 0; i < large.size(); ++i) 
+                { Prob[large[i]] = 1.0; Alias[large[i]] = large[i]; }
+            for (size_t i = 0; i < small.size(); ++i) 
+                { Prob[small[i]] = 1.0; Alias[small[i]] = small[i]; }
+        };
+
+        // table contents, for checkpoints
+        void
+        save_state(std::ostream& os) const
+        {
+            Checkpoint::write_vector(os, Prob);
+            Checkpoint::write_vector(os, Alias);
+            Checkpoint::write(os, _total);
+        };
+
+        bool
+        load_state(std::istream& is)
+        {
+            return(Checkpoint::read_vector(is, Prob) && 
+                   Checkpoint::read_vector(is, Alias) &&
+                   Checkpoint::read(is, _total) && Prob.size() == Alias.size());
+        };
+
+        /*! Sample an index
+
+            @param u   uniform draw in [0, 1)
+            @return    index i with probability weights[i] / total()
+         */
+        size_t
+        sample(double u) const
+        {
+            assert(! Prob.empty());
+            double x = u * Prob.size();
+            size_t i = static_cast<size_t>(x);
+            if (i >= Prob.size()) i = Prob.size() - 1;
+            return((x - i) < Prob[i] ? i : Alias[i]);
+        };
+};
+
+#endif // ALIASTABLE_H
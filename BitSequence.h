@@ -0,0 +1,217 @@
+#ifndef BITSEQUENCE_H
+#define BITSEQUENCE_H
+
+#include <vector>
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <stdint.h>
+
+/*! @class BitSequence
+
+    @brief A sequence of 0/1 sites packed 64 to a machine word.
+
+    Sites are numbered from 0, site i lives in bit (i % 64) of word (i / 64).
+    Bits beyond size() in the last word are always kept 0, so that counts can
+    be taken a whole word at a time.  Ranges are half-open, [first, last).
+
+    The words are normally held in a std::vector, but may instead live in
+    memory owned elsewhere, such as a MappedFile, see attach().  Copies
+    always hold their own words.
+ */
+class BitSequence {
+
+    public:
+
+        typedef uint64_t       word_type;
+        typedef size_t         size_type;
+
+        enum { word_bits = 64 };
+
+    private:
+
+        size_type                _size;
+        std::vector<word_type>   Own;  // the words, unless attached
+        word_type*               W;    // the words in use
+        size_type                _num_words;
+        bool                     _attached;
+
+        void
+        use_own()
+        {
+            W = Own.empty() ? 0 : &Own[0];
+            _num_words = Own.size();
+            _attached = false;
+        };
+
+        static size_type  word_of(size_type i)   { return(i / word_bits); };
+        static word_type  bit_of(size_type i)
+        { return(word_type(1) << (i % word_bits)); };
+        static size_type  words_for(size_type n)
+        { return((n + word_bits - 1) / word_bits); };
+
+        //! mask of bits [lo, hi) within a single word, 0 <= lo < hi <= 64
+        static word_type  mask(size_type lo, size_type hi)
+        {
+            word_type m = (hi == word_bits) ? ~word_type(0)
+                                            : ((word_type(1) << hi) - 1);
+            return(m & ~((word_type(1) << lo) - 1));
+        };
+
+        //! clear any bits beyond _size in the last word
+        void trim()
+        {
+            if (_size % word_bits)
+                W[_num_words - 1] &= mask(0, _size % word_bits);
+        };
+
+    public:
+
+        /*! constructor
+
+            @param n      number of sites
+            @param value  initial value of every site
+         */
+        BitSequence(size_type n = 0, bool value = false) 
+            : _size(0), W(0), _num_words(0), _attached(false)
+        { assign(n, value); };
+
+        BitSequence(const BitSequence& b)
+            : _size(b._size), Own(b.W, b.W + b._num_words)
+        { use_own(); };
+
+        BitSequence&
+        operator=(const BitSequence& b)
+        {
+            if (this == &b) return(*this);
+            _size = b._size;
+            Own.assign(b.W, b.W + b._num_words);
+            use_own();
+            return(*this);
+        };
+
+        //! Resize to n sites, all set to value; attached words are kept if
+        //! they are the right number, otherwise the sequence is detached
+        void assign(size_type n, bool value)
+        {
+            _size = n;
+            const word_type v = value ? ~word_type(0) : word_type(0);
+            if (_attached && _num_words == words_for(n)) {
+                for (size_type w = 0; w < _num_words; ++w) W[w] = v;
+            } else {
+                Own.assign(words_for(n), v);
+                use_own();
+            }
+            if (n) trim();
+        };
+
+        /*! Use the n sites held in words w, which must have room for
+            words_for(n) words and stay valid until detach() or assign()
+            to a different size.  The contents of w are kept, apart from
+            clearing bits beyond n.
+         */
+        void attach(word_type* w, size_type n)
+        {
+            std::vector<word_type>().swap(Own);
+            _size = n;
+            W = w;
+            _num_words = words_for(n);
+            _attached = true;
+            if (n) trim();
+        };
+
+        //! Exchange contents with b without copying words
+        void swap(BitSequence& b)
+        {
+            std::swap(_size, b._size);
+            Own.swap(b.Own);
+            std::swap(W, b.W);
+            std::swap(_num_words, b._num_words);
+            std::swap(_attached, b._attached);
+        };
+
+        //! Copy attached words into our own storage and stop using them
+        void detach()
+        {
+            if (! _attached) return;
+            Own.assign(W, W + _num_words);
+            use_own();
+        };
+
+        bool              attached() const   { return(_attached); };
+        size_type         size() const       { return(_size); };
+        size_type         num_words() const  { return(_num_words); };
+        const word_type*  words() const      { return(W); };
+        word_type*        words()            { return(W); };
+
+        //! Number of words needed for n sites
+        static size_type  words_for_size(size_type n) { return(words_for(n)); };
+
+        bool get(size_type i) const
+        { assert(i < _size); return((W[word_of(i)] & bit_of(i)) != 0); };
+
+        void set(size_type i, bool value)
+        {
+            assert(i < _size);
+            if (value) W[word_of(i)] |= bit_of(i);
+            else       W[word_of(i)] &= ~bit_of(i);
+        };
+
+        void flip(size_type i)
+        { assert(i < _size); W[word_of(i)] ^= bit_of(i); };
+
+        /*! Set every site in [first, last) to value, a word at a time
+
+            @param first  first site of the range
+            @param last   one past the last site of the range
+            @param value  value to set
+         */
+        void set_range(size_type first, size_type last, bool value)
+        {
+            assert(first <= last && last <= _size);
+            if (first == last) return;
+            size_type fw = word_of(first), lw = word_of(last - 1);
+            size_type fb = first % word_bits, lb = (last - 1) % word_bits + 1;
+            if (fw == lw) {
+                word_type m = mask(fb, lb);
+                if (value) W[fw] |= m; else W[fw] &= ~m;
+                return;
+            }
+            if (value) {
+                W[fw] |= mask(fb, word_bits);
+                for (size_type w = fw + 1; w < lw; ++w) W[w] = ~word_type(0);
+                W[lw] |= mask(0, lb);
+            } else {
+                W[fw] &= ~mask(fb, word_bits);
+                for (size_type w = fw + 1; w < lw; ++w) W[w] = word_type(0);
+                W[lw] &= ~mask(0, lb);
+            }
+        };
+
+        //! Number of sites set to 1
+        size_type count() const
+        {
+            size_type ans = 0;
+            for (size_type w = 0; w < _num_words; ++w)
+                ans += __builtin_popcountll(W[w]);
+            return(ans);
+        };
+
+        //! Number of sites set to 1 in [first, last)
+        size_type count(size_type first, size_type last) const
+        {
+            assert(first <= last && last <= _size);
+            if (first == last) return(0);
+            size_type fw = word_of(first), lw = word_of(last - 1);
+            size_type fb = first % word_bits, lb = (last - 1) % word_bits + 1;
+            if (fw == lw)
+                return(__builtin_popcountll(W[fw] & mask(fb, lb)));
+            size_type ans = __builtin_popcountll(W[fw] & mask(fb, word_bits));
+            for (size_type w = fw + 1; w < lw; ++w)
+                ans += __builtin_popcountll(W[w]);
+            ans += __builtin_popcountll(W[lw] & mask(0, lb));
+            return(ans);
+        };
+};
+
+#endif // BITSEQUENCE_H
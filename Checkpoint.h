@@ -0,0 +1,82 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+/////////////////////////////////////////////
+//
+// Helpers for writing and reading simulation state in binary checkpoints,
+// see Chromosome::save_checkpoint().  Values are written in native byte
+// order and size, so a checkpoint is only portable between machines with
+// the same architecture.
+//
+/////////////////////////////////////////////
+
+#include <vector>
+#include <deque>
+#include <string>
+#include <iostream>
+
+namespace Checkpoint {
+
+    //! Write a plain-old-data value
+    template<class T>
+    inline void
+    write(std::ostream& os, const T& val)
+    { os.write(reinterpret_cast<const char*>(&val), sizeof(T)); }
+
+    //! Read a plain-old-data value, returning false on a short read
+    template<class T>
+    inline bool
+    read(std::istream& is, T& val)
+    { return(bool(is.read(reinterpret_cast<char*>(&val), sizeof(T)))); }
+
+    //! Write an array of plain-old-data values
+    template<class T>
+    inline void
+    write_array(std::ostream& os, const T* val, const size_t n)
+    { if (n) os.write(reinterpret_cast<const char*>(val), n * sizeof(T)); }
+
+    template<class T>
+    inline bool
+    read_array(std::istream& is, T* val, const size_t n)
+    { return(n == 0 || bool(is.read(reinterpret_cast<char*>(val), n * sizeof(T)))); }
+
+    //! Write a vector of plain-old-data values, preceded by its size
+    template<class T>
+    inline void
+    write_vector(std::ostream& os, const std::vector<T>& Vec)
+    {
+        write(os, static_cast<unsigned long>(Vec.size()));
+        write_array(os, Vec.empty() ? 0 : &Vec[0], Vec.size());
+    }
+
+    template<class T>
+    inline bool
+    read_vector(std::istream& is, std::vector<T>& Vec)
+    {
+        unsigned long n;
+        if (! read(is, n)) return(false);
+        Vec.resize(n);
+        return(read_array(is, Vec.empty() ? 0 : &Vec[0], n));
+    }
+
+    //! Write a deque of plain-old-data values, preceded by its size
+    template<class T>
+    inline void
+    write_deque(std::ostream& os, const std::deque<T>& Deq)
+    {
+        write_vector(os, std::vector<T>(Deq.begin(), Deq.end()));
+    }
+
+    template<class T>
+    inline bool
+    read_deque(std::istream& is, std::deque<T>& Deq)
+    {
+        std::vector<T> Vec;
+        if (! read_vector(is, Vec)) return(false);
+        Deq.assign(Vec.begin(), Vec.end());
+        return(true);
+    }
+
+}  // namespace Checkpoint
+
+#endif // CHECKPOINT_H
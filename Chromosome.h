@@ -6,15 +6,29 @@
 #include "GC.h"
 #include "VectorUtility.h"
 #include "RandUniform.h"
+#include "RandUniformPool.h"
 #include "RandBinomial.h"
 #include "RandGeometric.h"
+#include "TractLength.h"
+#include "RateMap.h"
+#include "FenwickSampler.h"
 #include "Histogram.h"
+#include "BitSequence.h"
+#include "EventLog.h"
+#include "Checkpoint.h"
+#include "RunMap.h"
+#include "SparseSet.h"
+#include "MappedFile.h"
+#include "EquilibriumMonitor.h"
+#include "TimeSeries.h"
 
 #include <iostream>
 #include <iomanip>
 #include <cassert>
+#include <climits>
 #include <vector>
 #include <deque>
+#include <algorithm>
 #include <list>
 #include <map>
 
@@ -36,55 +50,252 @@ class Chromosome {
 
         typedef sequence_type::size_type       SeqSize_t;
         typedef sequence_type::difference_type SeqTract_t;
+        typedef long                           Tick_t;
+
+        // Storage for the sequence.  STORAGE_VECTOR holds one bp per site in
+        // X; STORAGE_BITS packs sites 64 to a word, which is 16x smaller and
+        // lets tract conversion and heterozygosity counts work a word at a
+        // time.  STORAGE_RUNS holds only the runs of homozygous and
+        // heterozygous sites, in the RunMap Runs, so memory scales with the
+        // number of runs rather than nbp and site lookup and tract
+        // conversion are O(log runs); runs are then always tracked.
+        // STORAGE_SPARSE holds only the positions of heterozygous sites, in
+        // a SparseSet, so memory scales with diversity, heterozygous counts
+        // are O(1) and a tract made homozygous is a range deletion.
+        // STORAGE_MAPPED packs sites as STORAGE_BITS does, but in a
+        // memory-mapped image file, so that the operating system pages the
+        // sequence in and out as needed and the file is a snapshot of the
+        // sequence; see set_storage_mapped().  All
+        // site access below goes through get_site(), set_site() and
+        // set_tract(), so that the rest of Chromosome need not know which
+        // storage is in use.
+        enum storage_type { STORAGE_VECTOR = 0, STORAGE_BITS = 1, 
+                            STORAGE_RUNS = 2, STORAGE_SPARSE = 3,
+                            STORAGE_MAPPED = 4 };
 
     private:
 
         SeqSize_t             _nbp; // nbp: number of bp to model
+        storage_type          _storage;
+        BitSequence           B;  // the sequence, for STORAGE_BITS and _MAPPED
+        SparseSet<SeqSize_t>  H;  // heterozygous sites, for STORAGE_SPARSE
+        MappedFile            Map;  // image holding B, for STORAGE_MAPPED
+        std::string           _mapped_filename;
+
+        bool  packed() const 
+        { return(_storage == STORAGE_BITS || _storage == STORAGE_MAPPED); };
+
+        // hint to the kernel that the mapped sequence is about to be
+        // scanned from end to end, or is back to being accessed at random
+        void
+        advise_scan(bool scan) const
+        {
+            if (_storage == STORAGE_MAPPED)
+                Map.advise(scan ? MappedFile::ADVISE_SEQUENTIAL
+                                : MappedFile::ADVISE_RANDOM);
+        };
+
+        bool  map_image(const std::string& filename);
+        void  unmap_image();
+        sequence_type         _sequence_copy;  // for get_sequence()
 
         // for set_heterozygosity()
         bool                  _random_seed;
-        RandUniform           Unif;
+        RandUniformPool       Unif;
+
+        // for set_seed()
+        bool                  _seeded;
+        unsigned long         _seed;
 
     public:
 
-        sequence_type        X;
+        // Runs of homozygosity and heterozygosity, kept up to date as sites
+        // change when set_track_runs(true), see RunMap.  With STORAGE_RUNS
+        // these are the sequence itself.
+        typedef RunMap<bp, Scalar>   run_map_type;
+
+    private:
+
+        bool                  _track_runs;
+        run_map_type          Runs;
+
+        // make a site heterozygous, for SparseSet::for_each(); S may hold
+        // a segment of the sequence starting at site first
+        struct SetHetz {
+            sequence_type& S;
+            const SeqSize_t first;
+            SetHetz(sequence_type& s, const SeqSize_t f = 0) : S(s), first(f) { };
+            void operator()(const SeqSize_t i) const { S[i - first] = HETZ; };
+        };
+        struct SetHetzBit {
+            BitSequence& S;
+            SetHetzBit(BitSequence& s) : S(s) { };
+            void operator()(const SeqSize_t i) const { S.set(i, true); };
+        };
+
+        struct SiteGet {
+            const Chromosome& C;
+            SiteGet(const Chromosome& c) : C(c) { };
+            bp operator()(const Scalar i) const { return(C.get_site(i)); };
+        };
+
+    public:
+
+        bool                 get_track_runs() const { return(_track_runs); };
+        const run_map_type&  get_runs() const       { return(Runs); };
+
+        //! runs cannot be untracked with STORAGE_RUNS
+        void
+        set_track_runs(bool tr)
+        {
+            if (_storage == STORAGE_RUNS) { _track_runs = true; return; }
+            _track_runs = tr;
+            if (_track_runs) rebuild_runs();
+            else Runs.assign(0, HOMZ);
+        };
+
+        //! rebuild the runs from the sequence, O(nbp)
+        void
+        rebuild_runs()
+        {
+            if (_storage == STORAGE_RUNS) return;
+            advise_scan(true);
+            Runs.fill(Scalar(get_nbp()), SiteGet(*this));
+            advise_scan(false);
+        };
+
+        sequence_type        X;  // the sequence, for STORAGE_VECTOR
 
         void                 set_nbp(SeqSize_t n) { _nbp = n; };
         SeqSize_t            get_nbp() const      { return(_nbp); };
-        const sequence_type& get_sequence()       { return X; };
         SeqSize_t            size() const         { check(); return(get_nbp()); };
-        void                 fill(bp bpstate)     { X.assign(get_nbp(), bpstate); };
+        storage_type         get_storage() const  { return(_storage); };
+        void                 set_storage(storage_type st);
+
+        // Switch to STORAGE_MAPPED with the current sequence written to a
+        // new image file, or map the sequence and nbp from an existing
+        // image.  The image is a page-sized header followed by the
+        // sequence bit-packed as in BitSequence, starting on a page
+        // boundary; see Chromosome_mapped.cpp.
+        bool                 set_storage_mapped(const std::string& filename);
+        bool                 open_mapped(const std::string& filename);
+        //! write the mapped sequence back to its image now
+        bool                 sync_mapped()        { return(Map.sync()); };
+        const std::string&   get_mapped_filename() const
+        { return(_mapped_filename); };
+        const sequence_type& get_sequence();
+        //! copy sites [first, last) into seg, for scanning the sequence a
+        //! segment at a time whatever the storage
+        void                 get_segment(SeqSize_t first, SeqSize_t last,
+                                         sequence_type& seg) const;
+        //! pack the sequence into b, a word or a run at a time where possible
+        void                 copy_to_bits(BitSequence& b) const;
+
+        bp
+        get_site(SeqSize_t i) const
+        {
+            if (packed()) return(B.get(i) ? HETZ : HOMZ);
+            if (_storage == STORAGE_RUNS) return(Runs.get(i));
+            if (_storage == STORAGE_SPARSE) return(H.contains(i) ? HETZ : HOMZ);
+            return(X[i]);
+        };
 
         void
-        init(SeqSize_t nnbp = -1) 
+        set_site(SeqSize_t i, bp bpstate)
         {
-            if (nnbp >= 0) {
-                set_nbp(nnbp); 
-                X.resize(get_nbp());
+            if (_dynamic_breaks) update_break_weight(i, bpstate);
+            if (_storage == STORAGE_RUNS) { Runs.set(i, bpstate); return; }
+            if (packed()) B.set(i, bpstate == HETZ);
+            else if (_storage == STORAGE_SPARSE) {
+                if (bpstate == HETZ) H.insert(i);
+                else H.erase(i);
+            } else X[i] = bpstate;
+            if (_track_runs) Runs.set(i, bpstate);
+        };
+
+        //! set sites first through last, inclusive, to bpstate
+        void
+        set_tract(SeqSize_t first, SeqSize_t last, bp bpstate)
+        {
+            if (_dynamic_breaks)
+                for (SeqSize_t i = first; i <= last; ++i) 
+                    update_break_weight(i, bpstate);
+            if (_storage == STORAGE_RUNS) {
+                Runs.assign_range(first, last + 1, bpstate);
+                return;
+            } else if (packed()) {
+                B.set_range(first, last + 1, bpstate == HETZ);
+            } else if (_storage == STORAGE_SPARSE) {
+                if (bpstate == HETZ) H.insert_range(first, last + 1);
+                else H.erase_range(first, last + 1);
+            } else {
+                for (SeqSize_t i = first; i <= last; ++i) X[i] = bpstate;
             }
-            Unif.init(_random_seed);
-            fill(HOMZ);
+            if (_track_runs) Runs.assign_range(first, last + 1, bpstate);
         };
 
         void
-        set_heterozygosity(double het = 0.0) 
+        fill(bp bpstate)
         {
-            fill(HOMZ);
-            for (SeqSize_t i = 0; i < X.size(); ++i) {
-                if (Unif.draw() < het) X[i] = HETZ;
+            if (_storage == STORAGE_RUNS) Runs.assign(get_nbp(), bpstate);
+            else {
+                if (packed()) B.assign(get_nbp(), bpstate == HETZ);
+                else if (_storage == STORAGE_SPARSE) {
+                    H.clear();
+                    if (bpstate == HETZ) H.insert_range(0, get_nbp());
+                } else X.assign(get_nbp(), bpstate);
+                if (_track_runs) Runs.assign(get_nbp(), bpstate);
+            }
+            if (_dynamic_breaks) rebuild_break_weights();
+        };
+
+        SeqSize_t            number_heterozygous() const;
+
+        void
+        init(SeqSize_t nnbp = -1) 
+        {
+            if (nnbp >= 0) {
+                set_nbp(nnbp); 
+                if (_storage == STORAGE_VECTOR) X.resize(get_nbp());
+                if (_storage == STORAGE_MAPPED && B.size() != get_nbp()) {
+                    B.assign(get_nbp(), false);
+                    map_image(_mapped_filename);
+                }
             }
+            if (_seeded) Unif.init_stream(stream(unif_stream));
+            else Unif.init(_random_seed);
+            if (MutateMap.size() != get_nbp()) MutateMap.clear();
+            if (DSBreakMap.size() != get_nbp()) DSBreakMap.clear();
+            fill(HOMZ);
+            unschedule();
         };
 
+        /*! Make sites heterozygous at random, the rest homozygous
+
+            @param het    probability that each site is heterozygous
+            @param exact  if true, make exactly round(het * nbp) sites
+                          heterozygous, chosen uniformly
+         */
+        void    set_heterozygosity(double het = 0.0, bool exact = false);
+
+    private:
+
+        void    place_heterozygous(const std::vector<SeqSize_t>& sites);
+
     private:
 
         void
         check() const 
         {
-            if (get_nbp() != X.size()) {
+            // sparse storage does not know its size
+            SeqSize_t stored = packed() ? B.size() : 
+                               (_storage == STORAGE_RUNS) ? Runs.size() : 
+                               (_storage == STORAGE_SPARSE) ? get_nbp() : X.size();
+            if (get_nbp() != stored) {
                 std::cerr << "Chromosome::check() : _nbp changed without init()"
                     << std::endl;
             }
-            assert(get_nbp() == X.size());
+            assert(get_nbp() == stored);
         };
 
     public:
@@ -95,14 +306,29 @@ class Chromosome {
          */
         Chromosome(const long sn = 0) 
             : _nbp(0),
+              _storage(STORAGE_VECTOR),
               _random_seed(RANDOM_SEED_FLAG),
+              _seeded(false),
+              _seed(0),
+              _track_runs(false),
               _mu(0.0),
               _did_mutate(false), 
               _c(0.0),
               _did_break(false),
-              _debug_trace(false)
+              _dynamic_breaks(false),
+              _tick(0),
+              _next_mutate_tick(unscheduled),
+              _next_break_tick(unscheduled),
+              _monitor_on(false),
+              _next_sample_tick(0),
+              _next_series_tick(0),
+              _next_series_event(0),
+              _debug_trace(false),
+              _debug_repair(1)
         { 
             _trace("CONSTRUCTOR ( sn )");
+            _break_weight[HOMZ] = _break_weight[HETZ] = 1.0;
+            init_streams();
             init(sn);
         };
 
@@ -121,7 +347,7 @@ class Chromosome {
 
         double            _mu;  // mutation rate per bp
         bool              _did_mutate;
-        RandUniform       mutate_Uniform;
+        RandUniformPool   mutate_Uniform;
 
         // Keeping track of mutation events
         struct MutationEvent {
@@ -148,27 +374,118 @@ class Chromosome {
             };
         };
 
-        std::deque<MutationEvent>    MutationLog;
+        // The log itself is held as columns, one per field of
+        // MutationEvent, and how much of it is kept is set with
+        // set_mutation_log(), see EventLog.
+        class MutationEventLog : public EventLog {
+            private:
+                std::vector<double>     Threshold, Draw;
+                std::vector<SeqSize_t>  Site;
+                std::vector<bp>         Orig, New;
+
+            protected:
+                void
+                resize_columns(const size_t n)
+                {
+                    Threshold.resize(n); Draw.resize(n); Site.resize(n);
+                    Orig.resize(n); New.resize(n);
+                };
+
+                void
+                write_columns(std::ostream& os, const size_t n) const
+                {
+                    Checkpoint::write_array(os, Threshold.data(), n);
+                    Checkpoint::write_array(os, Draw.data(), n);
+                    Checkpoint::write_array(os, Site.data(), n);
+                    Checkpoint::write_array(os, Orig.data(), n);
+                    Checkpoint::write_array(os, New.data(), n);
+                };
+
+                bool
+                read_columns(std::istream& is, const size_t n)
+                {
+                    return(Checkpoint::read_array(is, Threshold.data(), n) &&
+                           Checkpoint::read_array(is, Draw.data(), n) &&
+                           Checkpoint::read_array(is, Site.data(), n) &&
+                           Checkpoint::read_array(is, Orig.data(), n) &&
+                           Checkpoint::read_array(is, New.data(), n));
+                };
+
+            public:
+                ~MutationEventLog() { close(); };
+
+                void
+                push(double threshold, double draw, SeqSize_t site,
+                     bp val_orig, bp val_new)
+                {
+                    size_t i = append_slot();
+                    if (i == npos) return;
+                    Threshold[i] = threshold; Draw[i] = draw; Site[i] = site;
+                    Orig[i] = val_orig; New[i] = val_new;
+                };
+
+                //! event e, which must be resident()
+                MutationEvent
+                get(const long e) const
+                {
+                    size_t i = slot(e);
+                    MutationEvent event;
+                    event.event = e;
+                    event.event_threshold = Threshold[i];
+                    event.event_draw = Draw[i];
+                    event.event_site = Site[i];
+                    event.val_orig = Orig[i];
+                    event.val_new = New[i];
+                    return(event);
+                };
+        };
+
+        MutationEventLog             MutationLog;
+
+        // relative mutation rates along the chromosome, uniform if empty
+        RateMap                      MutateMap;
 
-        typedef std::deque<MutationEvent>::iterator         MutationDequeI;
-        typedef std::deque<MutationEvent>::const_iterator   MutationDequeCI;
+        double mutate_threshold() const 
+        { return(get_mu() * (MutateMap.empty() ? get_nbp() : MutateMap.total())); };
+        SeqSize_t mutate_draw_site();
+        void   mutate_site(SeqSize_t mutsite, double event_draw,
+                           double mut_event_threshold);
 
     public:
 
         void   mutate();
 
         double get_mu() const           { return(_mu); };
-        void   set_mu(double m)         { _mu = m; };
+        void   set_mu(double m)         { _mu = m; _next_mutate_tick = unscheduled; };
+
+        // Read relative mutation rates per site from a BED-like file, see
+        // RateMap::load(); the rate at a site is then mu times its relative
+        // rate.  The map is for the current nbp and is cleared by init() and
+        // open_mapped() when nbp changes.
+        void
+        load_mutate_map(const std::string& filename, double default_rate = 1.0)
+        {
+            MutateMap.load(filename, get_nbp(), 0, default_rate);
+            _next_mutate_tick = unscheduled;
+        };
+        void    clear_mutate_map()  { MutateMap.clear(); _next_mutate_tick = unscheduled; };
+        const RateMap&  get_mutate_map() const  { return(MutateMap); };
         bool   get_did_mutate() const   { return(_did_mutate); };
-        long   number_mutations() const { return(MutationLog.size()); };
+        long   number_mutations() const { return(MutationLog.count()); };
 
+        // how much of the mutation log to keep, see EventLog::set_mode()
+        void
+        set_mutation_log(EventLog::log_mode m, size_t capacity = 0,
+                         const std::string& filename = "")
+        { MutationLog.set_mode(m, capacity, filename); };
+
+        //! print the mutations still held in memory
         void
         print_mutations(std::ostream& os = std::cout, bool header = true) const
         {
             if (header) MutationEvent::print_header(os);
-            MutationDequeCI p;
-            for (p = MutationLog.begin(); p != MutationLog.end(); ++p)
-                (*p).print(os);
+            for (long e = MutationLog.first_resident(); e < MutationLog.count(); ++e)
+                MutationLog.get(e).print(os);
         };
 
 // // // // // // // // // // // // // // // // // // // // // // // //
@@ -182,16 +499,17 @@ class Chromosome {
 
         double             _c;   // gene conversion rate
         bool               _did_break;
-        RandUniform        dsbreak_Uniform;
+        RandUniformPool    dsbreak_Uniform;
 
-        // Keep track of double-stranded breaks.  We use the same
-        // structure for recording two functionally different deques
-        // of DSBs:
+        // Keep track of double-stranded breaks.  We keep two functionally
+        // different records of DSBs:
         //   - DSBreakLog, a log, like for mutations, that tracks
         //     all DSB events
         //   - DSBreakQueue, a queue that holds DSBs that must be
         //     repaired; this is filled and emptied as
-        //     DSBs are created and repaired.  
+        //     DSBs are created and repaired.  Its entries refer to 
+        //     DSBreakLog entries by event number rather than copying them,
+        //     and carry only the site needed for repair.
         struct DSBreakEvent { 
             long       event;
             double     event_threshold;
@@ -214,29 +532,179 @@ class Chromosome {
             };
         };
 
-        std::deque<DSBreakEvent>   DSBreakLog;
-        std::deque<DSBreakEvent>   DSBreakQueue;
+        class DSBreakEventLog : public EventLog {
+            private:
+                std::vector<double>     Threshold, Draw;
+                std::vector<SeqSize_t>  Site;
+
+            protected:
+                void
+                resize_columns(const size_t n)
+                { Threshold.resize(n); Draw.resize(n); Site.resize(n); };
+
+                void
+                write_columns(std::ostream& os, const size_t n) const
+                {
+                    Checkpoint::write_array(os, Threshold.data(), n);
+                    Checkpoint::write_array(os, Draw.data(), n);
+                    Checkpoint::write_array(os, Site.data(), n);
+                };
+
+                bool
+                read_columns(std::istream& is, const size_t n)
+                {
+                    return(Checkpoint::read_array(is, Threshold.data(), n) &&
+                           Checkpoint::read_array(is, Draw.data(), n) &&
+                           Checkpoint::read_array(is, Site.data(), n));
+                };
+
+            public:
+                ~DSBreakEventLog() { close(); };
+
+                void
+                push(double threshold, double draw, SeqSize_t site)
+                {
+                    size_t i = append_slot();
+                    if (i == npos) return;
+                    Threshold[i] = threshold; Draw[i] = draw; Site[i] = site;
+                };
+
+                //! event e, which must be resident()
+                DSBreakEvent
+                get(const long e) const
+                {
+                    size_t i = slot(e);
+                    DSBreakEvent event;
+                    event.event = e;
+                    event.event_threshold = Threshold[i];
+                    event.event_draw = Draw[i];
+                    event.event_site = Site[i];
+                    event.event_dir = 0;
+                    event.event_length = 0;
+                    return(event);
+                };
+        };
 
-        typedef std::deque<DSBreakEvent>::iterator         DSBreakDequeI;
-        typedef std::deque<DSBreakEvent>::const_iterator   DSBreakDequeCI;
+        // an entry in DSBreakQueue
+        struct DSBreakRef {
+            long       event;  // event number in DSBreakLog
+            SeqSize_t  event_site;
+        };
+
+        DSBreakEventLog          DSBreakLog;
+        std::deque<DSBreakRef>   DSBreakQueue;
+
+        typedef std::deque<DSBreakRef>::iterator         DSBreakDequeI;
+        typedef std::deque<DSBreakRef>::const_iterator   DSBreakDequeCI;
 
         enum { min_DSB_site = 1 };  // a named constant; we can't break beyond here
 
+        // relative break rates along the chromosome, uniform if empty
+        RateMap                  DSBreakMap;
+
+        // Sequence-dependent break rates.  When on, the relative break
+        // rate of each site is its rate in DSBreakMap (or 1) times
+        // _break_weight[HOMZ] or _break_weight[HETZ], depending on its
+        // current state.  Every change of state updates the site's weight
+        // in BreakWeights, in O(log nbp), and reschedules the next break
+        // if the total changed, which by memorylessness is exact.
+        bool                     _dynamic_breaks;
+        double                   _break_weight[2];
+        FenwickSampler           BreakWeights;
+
+        double
+        break_weight(SeqSize_t i, bp bpstate) const
+        {
+            if (i < min_DSB_site) return(0.0);
+            double base = DSBreakMap.empty() ? 1.0 : DSBreakMap.rate(i);
+            return(base * _break_weight[bpstate == HETZ ? HETZ : HOMZ]);
+        };
+        void
+        update_break_weight(SeqSize_t i, bp bpstate)
+        {
+            if (BreakWeights.set(i, break_weight(i, bpstate)))
+                _next_break_tick = unscheduled;
+        };
+        void    rebuild_break_weights();
+
+        double  dsbreak_threshold() const
+        { 
+            if (_dynamic_breaks) return(get_c() * BreakWeights.total());
+            return(get_c() * (DSBreakMap.empty() ? get_nbp() - min_DSB_site 
+                                                 : DSBreakMap.total())); 
+        };
+        SeqSize_t  dsbreak_draw_site();
+        void    dsbreak_site(SeqSize_t breaksite, double event_draw,
+                             double break_event_threshold);
+
     public:
 
         void    dsbreak();
         double  get_c() const           { return(_c); };
-        void    set_c(double c)         { _c = c; };
+        void    set_c(double c)         { _c = c; _next_break_tick = unscheduled; };
+
+        //! relative break rates per site, as for load_mutate_map()
+        void
+        load_dsbreak_map(const std::string& filename, double default_rate = 1.0)
+        {
+            DSBreakMap.load(filename, get_nbp(), min_DSB_site, default_rate);
+            if (_dynamic_breaks) rebuild_break_weights();
+            _next_break_tick = unscheduled;
+        };
+        void
+        clear_dsbreak_map()
+        {
+            DSBreakMap.clear();
+            if (_dynamic_breaks) rebuild_break_weights();
+            _next_break_tick = unscheduled;
+        };
+
+        /*! Make break rates depend on the state of each site
+
+            @param homz_weight  relative break rate of homozygous sites
+            @param hetz_weight  relative break rate of heterozygous sites
+         */
+        void
+        set_dynamic_breaks(double homz_weight, double hetz_weight)
+        {
+            _dynamic_breaks = true;
+            _break_weight[HOMZ] = homz_weight;
+            _break_weight[HETZ] = hetz_weight;
+            rebuild_break_weights();
+        };
+        void
+        clear_dynamic_breaks()
+        {
+            _dynamic_breaks = false;
+            BreakWeights.clear();
+            _next_break_tick = unscheduled;
+        };
+        bool    get_dynamic_breaks() const  { return(_dynamic_breaks); };
+        //! current relative break rate of site i
+        double
+        get_break_weight(SeqSize_t i) const
+        { 
+            if (_dynamic_breaks) return(BreakWeights.weight(i));
+            if (i < min_DSB_site) return(0.0);
+            return(DSBreakMap.empty() ? 1.0 : DSBreakMap.rate(i));
+        };
+        const RateMap&  get_dsbreak_map() const  { return(DSBreakMap); };
         bool    get_did_break() const   { return(_did_break); };
-        long    number_dsbreaks() const { return(DSBreakLog.size()); };
+        long    number_dsbreaks() const { return(DSBreakLog.count()); };
+
+        // how much of the break log to keep, see EventLog::set_mode()
+        void
+        set_dsbreak_log(EventLog::log_mode m, size_t capacity = 0,
+                        const std::string& filename = "")
+        { DSBreakLog.set_mode(m, capacity, filename); };
 
+        //! print the breaks still held in memory
         void
         print_dsbreaks(std::ostream& os = std::cout, bool header = true) const
         { 
             if (header) DSBreakEvent::print_header(os);
-            DSBreakDequeCI p;
-            for (p = DSBreakLog.begin(); p != DSBreakLog.end(); ++p)
-                (*p).print(os);
+            for (long e = DSBreakLog.first_resident(); e < DSBreakLog.count(); ++e)
+                DSBreakLog.get(e).print(os);
         };
 
 // // // // // // // // // // // // // // // // // // // // // // // //
@@ -248,9 +716,9 @@ class Chromosome {
 
     private:
 
-        RandUniform       repair1_Uniform;
-        RandGeometric     repair1_Geometric;
-        //RandGeometric     repair1_Geometric((1.0 - 0.99717), -100);
+        RandUniformPool   repair1_Uniform;
+        TractLength       repair1_Tract;
+        //repair1_Tract.set_geometric(1.0 - 0.99717);
 
     public:
 
@@ -262,11 +730,167 @@ class Chromosome {
 
         // repair1() implements a naive repair based on simply drawing a
         // direction from uniform and a tract length from a tract-length
-        // distribution.  It will be extended to model a variety of
-        // tract-length distributions.
+        // distribution.  The distribution is geometric with p = 0.1 unless
+        // set otherwise below, see TractLength.
 
         void              repair1();
 
+        void   set_tract_geometric(double p)     { repair1_Tract.set_geometric(p); };
+        void   set_tract_mixture(double w, double p1, double p2)
+        { repair1_Tract.set_mixture(w, p1, p2); };
+        void   set_tract_empirical(const std::vector<long>& lengths,
+                                   const std::vector<double>& weights)
+        { repair1_Tract.set_empirical(lengths, weights); };
+        void   load_tract_empirical(const std::string& filename)
+        { repair1_Tract.load_empirical(filename); };
+
+
+// // // // // // // // // // // // // // // // // // // // // // // //
+// // // // // // // // // // // // // // // // // // // // // // // //
+//
+// Event-driven simulation interfaces and members
+//
+// // // // // // // // // // // // // // // // // // // // // // // //
+
+    private:
+
+        // Rather than asking every tick whether a mutation or a break
+        // occurred, step() draws the geometric waiting time to the next tick
+        // holding each kind of event and jumps straight there.  The per-tick
+        // event probabilities are those used by mutate() and dsbreak(), so
+        // the event distributions are the same as calling mutate() and 
+        // dsbreak() once per tick.
+
+        enum { unscheduled = -1 };
+        static const Tick_t   never = LONG_MAX;
+
+        Tick_t                _tick;  // ticks elapsed under step()
+        Tick_t                _next_mutate_tick;
+        Tick_t                _next_break_tick;
+
+        Tick_t                schedule(RandUniformPool& unif, double p) const;
+
+    public:
+
+        // step() advances to the next tick at which a mutation and/or a
+        // break occurs and applies them, setting get_did_mutate() and
+        // get_did_break() as mutate() and dsbreak() would on that tick.  It
+        // returns the number of ticks advanced, or 0 if no event can occur.
+        // Breaks are queued for repair as with dsbreak().
+
+        Tick_t  step();
+        Tick_t  get_tick() const        { return(_tick); };
+        void    set_tick(Tick_t t)      { _tick = t; unschedule(); };
+        void    unschedule()
+        { _next_mutate_tick = unscheduled; _next_break_tick = unscheduled; };
+
+        //! tick of the next mutation or break, drawing it if need be
+        Tick_t  next_event_tick();
+
+        // run() drives the simulation with step() and repair1() for up to
+        // max_ticks ticks, feeding the equilibrium monitor, if one is set,
+        // with the state at every sample tick along the way.  It returns
+        // early if the monitor stops the run, and returns the number of
+        // ticks advanced.
+
+        Tick_t  run(Tick_t max_ticks);
+
+
+// // // // // // // // // // // // // // // // // // // // // // // //
+// // // // // // // // // // // // // // // // // // // // // // // //
+//
+// Statistics and equilibrium monitoring interfaces and members
+//
+// // // // // // // // // // // // // // // // // // // // // // // //
+
+    private:
+
+        bool                  _monitor_on;
+        EquilibriumMonitor    Monitor;
+        Tick_t                _next_sample_tick;
+
+    public:
+
+        //! fraction of sites heterozygous, O(1) when tracking runs
+        double  heterozygosity() const;
+        //! mean length of runs of homozygosity, requires tracking runs
+        double  mean_homozygous_run() const;
+
+        // Monitor the run for equilibrium, see EquilibriumMonitor.  This
+        // turns on run tracking, and samples start sample_interval ticks
+        // from now.
+        void
+        set_equilibrium_monitor(const EquilibriumMonitor& m)
+        {
+            Monitor = m;
+            Monitor.reset();
+            _monitor_on = true;
+            _next_sample_tick = _tick + Monitor.get_sample_interval();
+            if (! _track_runs) set_track_runs(true);
+        };
+        void    clear_equilibrium_monitor()  { _monitor_on = false; };
+        bool    get_monitor_on() const       { return(_monitor_on); };
+        const EquilibriumMonitor&
+                get_equilibrium_monitor() const { return(Monitor); };
+
+    private:
+
+        TimeSeries            Series;
+        Tick_t                _next_series_tick;
+        long                  _next_series_event;
+
+    public:
+
+        //! statistics of the current state, requires tracking runs
+        TimeSeries::Sample  get_sample() const;
+
+        // Record a time series of get_sample() during run(), see TimeSeries.
+        // This turns on run tracking; for EVERY_TICKS the first sample is
+        // taken now, for EVERY_EVENTS after the next interval events.
+        bool
+        set_time_series(const std::string& filename,
+                        const TimeSeries::interval_type t, const long interval,
+                        const TimeSeries::format_type f = TimeSeries::FORMAT_TSV,
+                        const size_t capacity = 4096)
+        {
+            if (! Series.open(filename, t, interval, f, capacity)) return(false);
+            _next_series_tick = _tick;
+            _next_series_event = number_mutations() + number_dsbreaks() + interval;
+            if (! _track_runs) set_track_runs(true);
+            return(true);
+        };
+        //! Write out the remaining samples and stop the time series
+        void    close_time_series()          { Series.close(); };
+        const TimeSeries&
+                get_time_series() const      { return(Series); };
+
+
+// // // // // // // // // // // // // // // // // // // // // // // //
+// // // // // // // // // // // // // // // // // // // // // // // //
+//
+// Checkpoint interfaces and members
+//
+// // // // // // // // // // // // // // // // // // // // // // // //
+
+    public:
+
+        // save_checkpoint() writes the full simulation state, including the
+        // sequence, rates, event logs, the repair queue, the event schedule
+        // and the state of every random number generator, to a binary file.
+        // load_checkpoint() restores it, after which the run continues
+        // exactly as it would have without interruption.  Both return false
+        // on failure; a failed load leaves the Chromosome as it was.  See
+        // Chromosome_checkpoint.cpp for the format.
+
+        enum { checkpoint_version = 8 };
+
+        bool   save_checkpoint(const std::string& filename) const;
+        bool   load_checkpoint(const std::string& filename);
+
+    private:
+
+        bool   read_state(std::istream& is, int& storage);
+
 
 // // // // // // // // // // // // // // // // // // // // // // // //
 // // // // // // // // // // // // // // // // // // // // // // // //
@@ -275,9 +899,59 @@ class Chromosome {
 //
 // // // // // // // // // // // // // // // // // // // // // // // //
 
+    private:
+
+        // Each random number generator owned by a Chromosome draws from its
+        // own numbered stream, so set_seed() gives every generator of every
+        // differently-seeded Chromosome a different sequence.
+        enum { unif_stream = 0, mutate_stream, dsbreak_stream, 
+               repair1_stream, repair1_tract_stream,
+               streams_per_seed = 8 };
+
+        unsigned long
+        stream(int s) const { return(_seed * streams_per_seed + s); };
+
+        // Put every generator but Unif, which init() seeds, on its own
+        // stream of _seed.  Called by the constructor too, so that even an
+        // unseeded Chromosome never draws two quantities from one sequence.
+        void
+        init_streams()
+        {
+            mutate_Uniform.init_stream(stream(mutate_stream));
+            dsbreak_Uniform.init_stream(stream(dsbreak_stream));
+            repair1_Uniform.init_stream(stream(repair1_stream));
+            repair1_Tract.init_stream(stream(repair1_tract_stream));
+        };
+
+    public:
+
+        // Reseed all random number generators from seed, which must be less
+        // than max_seed().  The same seed reproduces the same run, and
+        // different seeds draw from different streams.
+        void
+        set_seed(unsigned long seed)
+        {
+            if (seed >= max_seed()) {
+                std::cerr << "Chromosome::set_seed : seed must be less than "
+                    << max_seed() << std::endl;
+            }
+            assert(seed < max_seed());
+            _seed = seed;
+            _seeded = true;
+            Unif.init_stream(stream(unif_stream));
+            init_streams();
+            unschedule();
+        };
+
+        static unsigned long
+        max_seed() { return(RandUniform::num_streams / streams_per_seed); };
+
+        unsigned long get_seed() const  { return(_seed); };
+
     private:
 
         bool                  _debug_trace;
+        int                   _debug_repair;  // verbosity of repair*()
 
         void
         _trace(const std::string& s) const 
@@ -289,6 +963,8 @@ class Chromosome {
 
         bool   get_debug_trace() const  { return(_debug_trace); };
         void   set_debug_trace(bool dt) { _debug_trace = dt; };
+        int    get_debug_repair() const { return(_debug_repair); };
+        void   set_debug_repair(int dr) { _debug_repair = dr; };
 
         void   print_stats(std::ostream& os = std::cout, 
                            bool header = true) const;
@@ -329,16 +1005,225 @@ Chromosome::print_stats(std::ostream& os, bool header) const
 {
     _trace("print_stats ( os, header )");
 
-    if (X.size() == 0) { os << "zero-length chromosome" << std::endl; return; }
+    if (get_nbp() == 0) { os << "zero-length chromosome" << std::endl; return; }
 
     // site counts
     if (header) { 
         os << "Chromosome:: Summary Statistics" << std::endl; 
         os << "===============================" << std::endl;
     }
-    Histogram<bp, Scalar> site_histogram (X, false);
-    site_histogram.names("bp_state", "num_sites", "freq_sites");
-    site_histogram.print_table(os, header);
+    if (_storage == STORAGE_VECTOR) {
+        Histogram<bp, Scalar> site_histogram (X, false);
+        site_histogram.names("bp_state", "num_sites", "freq_sites");
+        site_histogram.print_table(os, header);
+    } else {
+        // with only two states, the counts come straight from popcount
+        SeqSize_t num_het = number_heterozygous();
+        Histogram<bp, Scalar> site_histogram;
+        site_histogram.add(HOMZ, get_nbp() - num_het);
+        site_histogram.add(HETZ, num_het);
+        site_histogram.names("bp_state", "num_sites", "freq_sites");
+        site_histogram.print_table(os, header);
+    }
+};
+
+
+inline double
+Chromosome::heterozygosity() const
+{
+    if (get_nbp() == 0) return(0.0);
+    if (_track_runs) {
+        run_map_type::stats_type_CI p = Runs.get_stats().find(HETZ);
+        if (p == Runs.get_stats().end()) return(0.0);
+        return(double(p->second.sum) / get_nbp());
+    }
+    return(double(number_heterozygous()) / get_nbp());
+};
+
+
+inline double
+Chromosome::mean_homozygous_run() const
+{
+    assert(_track_runs);
+    run_map_type::stats_type_CI p = Runs.get_stats().find(HOMZ);
+    if (p == Runs.get_stats().end()) return(0.0);
+    return(p->second.mean());
+};
+
+
+inline TimeSeries::Sample
+Chromosome::get_sample() const
+{
+    assert(_track_runs);
+    TimeSeries::Sample s = TimeSeries::Sample();
+    s.tick = _tick;
+    s.events = number_mutations() + number_dsbreaks();
+    s.het = heterozygosity();
+    for (run_map_type::stats_type_CI p = Runs.get_stats().begin();
+         p != Runs.get_stats().end(); ++p) {
+        const run_map_type::ItemStats& st = p->second;
+        if (st.num_runs == 0) continue;
+        if (p->first == HETZ) {
+            s.het_sites = st.sum;
+            s.het_runs = st.num_runs;
+            s.het_mean = st.mean();
+            s.het_var = st.var();
+        } else {
+            s.hom_runs = st.num_runs;
+            s.hom_mean = st.mean();
+            s.hom_var = st.var();
+        }
+    }
+    return(s);
+};
+
+
+inline Chromosome::SeqSize_t
+Chromosome::number_heterozygous() const
+{
+    _trace("number_heterozygous ( )");
+    if (_storage == STORAGE_BITS) return(B.count());
+    if (_storage == STORAGE_MAPPED) {
+        advise_scan(true);
+        SeqSize_t ans = B.count();
+        advise_scan(false);
+        return(ans);
+    }
+    if (_storage == STORAGE_SPARSE) return(H.size());
+    if (_storage == STORAGE_RUNS) {
+        run_map_type::stats_type_CI p = Runs.get_stats().find(HETZ);
+        return(p == Runs.get_stats().end() ? 0 : SeqSize_t(p->second.sum));
+    }
+    SeqSize_t ans = 0;
+    for (SeqSize_t i = 0; i < X.size(); ++i) ans += (X[i] == HETZ);
+    return(ans);
+};
+
+
+/*! Switch the sequence to storage st, preserving its contents.
+ */
+inline void
+Chromosome::set_storage(storage_type st)
+{
+    _trace("set_storage ( st )");
+    if (st == _storage) return;
+    if (st == STORAGE_MAPPED) {
+        if (_mapped_filename.empty()) {
+            std::cerr << "Chromosome::set_storage : no image file, see "
+                "set_storage_mapped()" << std::endl;
+            return;
+        }
+        if (! map_image(_mapped_filename)) return;
+    } else if (st == STORAGE_BITS) {
+        if (_storage == STORAGE_MAPPED) unmap_image();
+        else copy_to_bits(B);
+    } else if (st == STORAGE_RUNS) {
+        if (! _track_runs) rebuild_runs();
+        _track_runs = true;
+    } else if (st == STORAGE_SPARSE) {
+        std::vector<SeqSize_t> Het;
+        for (SeqSize_t i = 0; i < get_nbp(); ++i) 
+            if (get_site(i) == HETZ) Het.push_back(i);
+        H.assign(Het);
+    } else if (_storage == STORAGE_SPARSE) {
+        X.assign(get_nbp(), HOMZ);
+        H.for_each(SetHetz(X));
+    } else {
+        X.assign(get_nbp(), HOMZ);
+        advise_scan(true);
+        for (SeqSize_t i = 0; i < get_nbp(); ++i) 
+            if (get_site(i) == HETZ) X[i] = HETZ;
+        advise_scan(false);
+    }
+    // release the old storage, unless the new storage took it over
+    if (_storage == STORAGE_VECTOR) sequence_type().swap(X);
+    else if (_storage == STORAGE_SPARSE) H.clear();
+    else if (packed() && st != STORAGE_BITS && st != STORAGE_MAPPED) {
+        B.assign(0, false);
+        Map.close();
+    }
+    _storage = st;
+};
+
+
+inline void
+Chromosome::copy_to_bits(BitSequence& b) const
+{
+    _trace("copy_to_bits ( b )");
+    if (packed()) { 
+        advise_scan(true);
+        b = B;
+        advise_scan(false);
+        return;
+    }
+    b.assign(get_nbp(), false);
+    if (_storage == STORAGE_SPARSE) {
+        H.for_each(SetHetzBit(b));
+    } else if (_storage == STORAGE_RUNS) {
+        const run_map_type::run_map_type& S = Runs.get_starts();
+        for (run_map_type::run_map_CI p = S.begin(); p != S.end(); ) {
+            run_map_type::run_map_CI next = p; ++next;
+            if (p->second == HETZ) 
+                b.set_range(p->first, next == S.end() ? Runs.size() : next->first,
+                            true);
+            p = next;
+        }
+    } else {
+        for (SeqSize_t i = 0; i < X.size(); ++i) 
+            if (X[i] == HETZ) b.set(i, true);
+    }
+};
+
+
+/*! Return the sequence as a vector of bp.  With STORAGE_VECTOR this is X
+    itself; otherwise it is a copy made on each call, which is valid until the
+    next call.
+ */
+inline const Chromosome::sequence_type&
+Chromosome::get_sequence()
+{
+    _trace("get_sequence ( )");
+    if (_storage == STORAGE_VECTOR) return(X);
+    advise_scan(true);
+    get_segment(0, get_nbp(), _sequence_copy);
+    advise_scan(false);
+    return(_sequence_copy);
+};
+
+
+inline void
+Chromosome::get_segment(SeqSize_t first, SeqSize_t last, sequence_type& seg) const
+{
+    _trace("get_segment ( first, last, seg )");
+    assert(first <= last && last <= get_nbp());
+    seg.resize(last - first);
+    if (_storage == STORAGE_VECTOR) {
+        std::copy(X.begin() + first, X.begin() + last, seg.begin());
+        return;
+    }
+    if (_storage == STORAGE_RUNS) {
+        if (first == last) return;
+        const run_map_type::run_map_type& S = Runs.get_starts();
+        // the run holding first starts at or before it
+        run_map_type::run_map_CI p = S.upper_bound(first);
+        --p;
+        for ( ; p != S.end() && SeqSize_t(p->first) < last; ) {
+            run_map_type::run_map_CI next = p; ++next;
+            SeqSize_t start = VectorUtility::Max(SeqSize_t(p->first), first);
+            SeqSize_t end = (next == S.end()) ? last
+                            : VectorUtility::Min(SeqSize_t(next->first), last);
+            std::fill(seg.begin() + (start - first), seg.begin() + (end - first),
+                      p->second);
+            p = next;
+        }
+        return;
+    }
+    if (_storage == STORAGE_SPARSE) {
+        std::fill(seg.begin(), seg.end(), bp(HOMZ));
+        H.for_each(first, last, SetHetz(seg, first));
+        return;
+    }
+    for (SeqSize_t i = first; i < last; ++i) seg[i - first] = get_site(i);
 };
 
 
@@ -393,7 +1278,7 @@ Chromosome::print(std::ostream& os,
         }
         for (SeqSize_t j = i; j <= endslice; ++j) {
             if (j == markbp) os << (tract ? (tract > 0 ? ">" : "<") : "|");
-            os << ((X[j] == true) ? "1" : "0");
+            os << ((get_site(j) == HETZ) ? "1" : "0");
         }
         while (right_pad > 0) {
             os << pad;
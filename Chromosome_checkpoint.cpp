@@ -0,0 +1,251 @@
+#include "Chromosome.h"
+#include "Checkpoint.h"
+
+#include <fstream>
+#include <sstream>
+#include <cstring>
+
+/*! Methods implementing binary checkpoint and restart.
+
+  A checkpoint file is laid out as:
+
+      offset  size
+      0       8      magic "CHROMGC\0"
+      8       4      format version, checkpoint_version
+      12      4      size of this header in bytes, 48
+      16      8      number of sites, _nbp
+      24      8      byte offset of the sequence section
+      32      8      number of 64-bit words in the sequence section
+      40      8      byte length of the state section
+      48      ...    state section
+      ...            zero padding to the next multiple of checkpoint_page
+      offset  ...    sequence section
+
+  The state section holds everything but the sequence, in the order written
+  by save_checkpoint() below.  The sequence section holds the sequence
+  bit-packed as in BitSequence, whatever storage is in use, starting on a
+  page boundary so that it can be memory-mapped directly for large
+  sequences.  Values are in native byte order.
+ */
+
+namespace {
+
+    const char     checkpoint_magic[8] = { 'C', 'H', 'R', 'O', 'M', 'G', 'C', 0 };
+    const uint64_t checkpoint_page = 4096;
+
+    struct CheckpointHeader {
+        char      magic[8];
+        uint32_t  version;
+        uint32_t  header_size;
+        uint64_t  nbp;
+        uint64_t  sequence_offset;
+        uint64_t  sequence_words;
+        uint64_t  state_size;
+    };
+
+}
+
+bool
+Chromosome::save_checkpoint(const std::string& filename) const
+{
+    _trace("save_checkpoint ( filename )");
+
+    using namespace Checkpoint;
+
+    std::ostringstream state;
+    write(state, int(_storage));
+    write(state, _random_seed);
+    write(state, _seeded);
+    write(state, _seed);
+    write(state, static_cast<uint64_t>(_mapped_filename.size()));
+    state.write(_mapped_filename.data(), _mapped_filename.size());
+    write(state, _track_runs);
+    write(state, _mu);
+    write(state, _did_mutate);
+    MutateMap.save_state(state);
+    write(state, _c);
+    write(state, _did_break);
+    DSBreakMap.save_state(state);
+    write(state, _dynamic_breaks);
+    write_array(state, _break_weight, 2);
+    BreakWeights.save_state(state);
+    write(state, _tick);
+    write(state, _next_mutate_tick);
+    write(state, _next_break_tick);
+    write(state, _monitor_on);
+    write(state, _next_sample_tick);
+    Monitor.save_state(state);
+    write(state, _next_series_tick);
+    write(state, _next_series_event);
+    Series.save_state(state);
+    write(state, _debug_trace);
+    write(state, _debug_repair);
+    MutationLog.save_state(state);
+    DSBreakLog.save_state(state);
+    write_deque(state, DSBreakQueue);
+    Unif.save_state(state);
+    mutate_Uniform.save_state(state);
+    dsbreak_Uniform.save_state(state);
+    repair1_Uniform.save_state(state);
+    repair1_Tract.save_state(state);
+    const std::string state_str = state.str();
+
+    BitSequence packed;
+    const BitSequence* seq = &B;
+    if (_storage != STORAGE_BITS) {
+        copy_to_bits(packed);
+        seq = &packed;
+    }
+
+    CheckpointHeader h;
+    memcpy(h.magic, checkpoint_magic, sizeof(h.magic));
+    h.version = checkpoint_version;
+    h.header_size = sizeof(CheckpointHeader);
+    h.nbp = get_nbp();
+    h.state_size = state_str.size();
+    h.sequence_offset = ((sizeof(h) + h.state_size + checkpoint_page - 1) 
+                         / checkpoint_page) * checkpoint_page;
+    h.sequence_words = seq->num_words();
+
+    std::ofstream ofs(filename.c_str(), std::ios::binary | std::ios::trunc);
+    if (! ofs) {
+        std::cerr << "Chromosome::save_checkpoint : cannot open " << filename
+            << std::endl;
+        return(false);
+    }
+    write(ofs, h);
+    ofs.write(state_str.data(), state_str.size());
+    const std::string pad(h.sequence_offset - sizeof(h) - h.state_size, '\0');
+    ofs.write(pad.data(), pad.size());
+    write_array(ofs, seq->words(), seq->num_words());
+    ofs.flush();
+    if (! ofs) {
+        std::cerr << "Chromosome::save_checkpoint : error writing " << filename
+            << std::endl;
+        return(false);
+    }
+    return(true);
+};
+
+bool
+Chromosome::load_checkpoint(const std::string& filename)
+{
+    _trace("load_checkpoint ( filename )");
+
+    using namespace Checkpoint;
+
+    std::ifstream ifs(filename.c_str(), std::ios::binary);
+    if (! ifs) {
+        std::cerr << "Chromosome::load_checkpoint : cannot open " << filename
+            << std::endl;
+        return(false);
+    }
+    CheckpointHeader h;
+    if (! read(ifs, h) || memcmp(h.magic, checkpoint_magic, sizeof(h.magic)) ||
+        h.header_size != sizeof(CheckpointHeader)) {
+        std::cerr << "Chromosome::load_checkpoint : " << filename 
+            << " is not a checkpoint" << std::endl;
+        return(false);
+    }
+    if (h.version != checkpoint_version) {
+        std::cerr << "Chromosome::load_checkpoint : " << filename 
+            << " has version " << h.version << ", expected " 
+            << checkpoint_version << std::endl;
+        return(false);
+    }
+
+    // read both sections whole, so that nothing is changed until the
+    // checkpoint is known to be sound
+    ifs.seekg(0, std::ios::end);
+    const uint64_t file_size = ifs.tellg();
+    bool ok = (h.sequence_offset >= sizeof(h)) &&
+              (h.state_size <= h.sequence_offset - sizeof(h)) &&
+              (h.sequence_offset <= file_size) &&
+              (h.sequence_words == BitSequence::words_for_size(h.nbp)) &&
+              (h.sequence_words <= (file_size - h.sequence_offset) / 
+                                   sizeof(BitSequence::word_type));
+    std::string state;
+    BitSequence seq;
+    if (ok) {
+        state.resize(h.state_size);
+        seq.assign(h.nbp, false);
+        ok = ifs.seekg(sizeof(h)) && 
+             (h.state_size == 0 || ifs.read(&state[0], h.state_size)) &&
+             ifs.seekg(h.sequence_offset) &&
+             read_array(ifs, seq.words(), seq.num_words());
+    }
+    // parse the state into a scratch Chromosome first; only if that
+    // succeeds is it parsed again into this one, which cannot then fail
+    int storage;
+    if (ok) {
+        Chromosome scratch;
+        std::istringstream is(state);
+        ok = scratch.read_state(is, storage);
+    }
+    if (! ok) {
+        std::cerr << "Chromosome::load_checkpoint : " << filename 
+            << " is truncated or corrupt" << std::endl;
+        return(false);
+    }
+    std::istringstream is(state);
+    read_state(is, storage);
+    MutationLog.resume();
+    DSBreakLog.resume();
+    Series.resume();
+
+    // the sequence is taken in bit-packed storage, then converted to the
+    // storage in use when the checkpoint was saved; a mapped image is
+    // rewritten from the checkpoint
+    sequence_type().swap(X);
+    if (_storage == STORAGE_MAPPED) {
+        B.assign(0, false);
+        Map.close();
+    }
+    _storage = STORAGE_BITS;
+    set_nbp(h.nbp);
+    B.swap(seq);
+    if (_track_runs || storage == STORAGE_RUNS) rebuild_runs();
+    set_storage(storage_type(storage));
+    return(true);
+};
+
+
+// Read the state section of a checkpoint, as written by save_checkpoint(),
+// into this Chromosome; storage receives the storage type saved.  Returns
+// false if the section is truncated or corrupt, leaving this Chromosome
+// partly overwritten.
+
+bool
+Chromosome::read_state(std::istream& is, int& storage)
+{
+    _trace("read_state ( is, storage )");
+
+    using namespace Checkpoint;
+
+    uint64_t len;
+    bool ok = read(is, storage) && read(is, _random_seed) &&
+              read(is, _seeded) && read(is, _seed) && read(is, len);
+    if (ok) {
+        _mapped_filename.resize(len);
+        ok = (len == 0 || is.read(&_mapped_filename[0], len));
+    }
+    return(ok && read(is, _track_runs) &&
+           read(is, _mu) && read(is, _did_mutate) &&
+           MutateMap.load_state(is) &&
+           read(is, _c) && read(is, _did_break) &&
+           DSBreakMap.load_state(is) && read(is, _dynamic_breaks) &&
+           read_array(is, _break_weight, 2) && BreakWeights.load_state(is) &&
+           read(is, _tick) && read(is, _next_mutate_tick) &&
+           read(is, _next_break_tick) && read(is, _monitor_on) &&
+           read(is, _next_sample_tick) && Monitor.load_state(is) &&
+           read(is, _next_series_tick) && read(is, _next_series_event) &&
+           Series.load_state(is) &&
+           read(is, _debug_trace) &&
+           read(is, _debug_repair) &&
+           MutationLog.load_state(is) && DSBreakLog.load_state(is) &&
+           read_deque(is, DSBreakQueue) &&
+           Unif.load_state(is) && mutate_Uniform.load_state(is) &&
+           dsbreak_Uniform.load_state(is) && 
+           repair1_Uniform.load_state(is) &&
+           repair1_Tract.load_state(is));
+};
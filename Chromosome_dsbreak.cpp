@@ -15,30 +15,65 @@ Chromosome::dsbreak()
     //    distribution multiplied by number of sites then rounded down.  Note
     //    that the number of break sites (since breaks only occur between bases)
     //    is the length of the chromosome - 1.  We might want to handle telomeres
-    //    here.
+    //    here.  With a rate map, the site is drawn from it instead.
     // 3  Add an entry to the DSBreakEventLog
     // 4  Save the decision to repair until Chromosome::mmr(), which fetches
     //    the DSBreakEventLog entry and does its thing.
     //
 
-    SeqSize_t num_sites = get_nbp() - min_DSB_site; // number of potential breaks
-    double break_event_threshold = (get_c() * num_sites);  // rate * num sites
+    double break_event_threshold = dsbreak_threshold();  // rate * num sites
     double event_draw;
     if ((event_draw = dsbreak_Uniform.draw()) < break_event_threshold) {
-        SeqSize_t breaksite = 
-            static_cast<SeqSize_t>((dsbreak_Uniform.draw() * num_sites)) 
-            + min_DSB_site;
-        // we only create the entry, Chromosome::mmr() fixes it
-        DSBreakEvent event;
-        event.event = DSBreakLog.size();
-        event.event_threshold = break_event_threshold;
-        event.event_draw = event_draw;
-        event.event_site = breaksite;
-        DSBreakLog.push_back(event);  // add to the global log
-        DSBreakQueue.push_back(event);  // add to the (this-iteration) queue
+        SeqSize_t breaksite = dsbreak_draw_site();
+        dsbreak_site(breaksite, event_draw, break_event_threshold);
         _did_break= true;
     } else { 
         _did_break = false; 
     }
 };
 
+// Draw the site of a break, uniformly, from the rate map, or from the
+// current sequence-dependent weights.
+
+Chromosome::SeqSize_t
+Chromosome::dsbreak_draw_site()
+{
+    if (_dynamic_breaks) return(BreakWeights.sample(dsbreak_Uniform.draw()));
+    if (DSBreakMap.empty()) {
+        SeqSize_t num_sites = get_nbp() - min_DSB_site; // number of potential breaks
+        return(static_cast<SeqSize_t>((dsbreak_Uniform.draw() * num_sites)) 
+               + min_DSB_site);
+    }
+    double u_bin = dsbreak_Uniform.draw();
+    return(DSBreakMap.sample(u_bin, dsbreak_Uniform.draw()));
+};
+
+// Log a break at breaksite and queue it for repair.
+
+void
+Chromosome::dsbreak_site(SeqSize_t breaksite, double event_draw,
+                         double break_event_threshold)
+{
+    // we only create the entry, Chromosome::mmr() fixes it
+    DSBreakRef ref;
+    ref.event = DSBreakLog.count();
+    ref.event_site = breaksite;
+    DSBreakLog.push(break_event_threshold, event_draw, breaksite);  // add to the global log
+    DSBreakQueue.push_back(ref);  // add to the (this-iteration) queue
+};
+
+// Recompute the relative break rate of every site from its state, O(nbp).
+
+void
+Chromosome::rebuild_break_weights()
+{
+    _trace("rebuild_break_weights ( )");
+    std::vector<double> weights(get_nbp());
+    advise_scan(true);
+    for (SeqSize_t i = 0; i < get_nbp(); ++i) 
+        weights[i] = break_weight(i, get_site(i));
+    advise_scan(false);
+    BreakWeights.build(weights);
+    _next_break_tick = unscheduled;
+};
+
@@ -0,0 +1,107 @@
+#include "Chromosome.h"
+
+#include <cmath>
+#include <algorithm>
+#include <unordered_set>
+
+/*! Method setting an initial random sequence.
+
+  @sa place_heterozygous
+
+  Rather than a draw for every site, the heterozygous sites are found
+  directly.  With each site independently heterozygous with probability
+  het, the number of homozygous sites before the next heterozygous one is
+  geometric, so we jump from one heterozygous site to the next with a
+  single draw each.  With exact, Floyd's algorithm picks a uniform sample
+  of k = round(het * nbp) distinct sites with k draws (Bentley & Floyd
+  1987, A sample of brilliance, Communications of the ACM 30:754-757), from
+  the homozygous sites instead when k > nbp / 2.  Either way the cost is
+  proportional to the number of heterozygous sites, plus clearing the
+  sequence, which packed storage does a word at a time.
+ */
+
+void
+Chromosome::set_heterozygosity(double het, bool exact)
+{
+    _trace("set_heterozygosity ( het, exact )");
+
+    const SeqSize_t n = get_nbp();
+    std::vector<SeqSize_t> sites;
+    if (exact) {
+        SeqSize_t k = static_cast<SeqSize_t>(floor(VectorUtility::Max(het, 0.0) * n + 0.5));
+        if (k > n) k = n;
+        const bool complement = (k > n / 2);
+        const SeqSize_t m = complement ? n - k : k;
+        std::unordered_set<SeqSize_t> chosen(m);
+        for (SeqSize_t j = n - m; j < n; ++j) {
+            SeqSize_t t = static_cast<SeqSize_t>(Unif.draw() * (j + 1));
+            if (t > j) t = j;
+            if (! chosen.insert(t).second) chosen.insert(j);
+        }
+        if (complement) {
+            std::vector<SeqSize_t> skip(chosen.begin(), chosen.end());
+            std::sort(skip.begin(), skip.end());
+            sites.reserve(k);
+            std::vector<SeqSize_t>::const_iterator p = skip.begin();
+            for (SeqSize_t i = 0; i < n; ++i) {
+                if (p != skip.end() && *p == i) ++p;
+                else sites.push_back(i);
+            }
+        } else {
+            sites.assign(chosen.begin(), chosen.end());
+            std::sort(sites.begin(), sites.end());
+        }
+    } else if (het >= 1.0) {
+        sites.reserve(n);
+        for (SeqSize_t i = 0; i < n; ++i) sites.push_back(i);
+    } else if (het > 0.0) {
+        sites.reserve(static_cast<SeqSize_t>(het * n * 1.01) + 16);
+        const double log_q = log1p(-het);
+        SeqSize_t i = 0;
+        for (;;) {
+            // homozygous sites before the next heterozygous one; 1 - draw()
+            // is in (0, 1]
+            double gap = floor(log(1.0 - Unif.draw()) / log_q);
+            if (gap >= static_cast<double>(n - i)) break;
+            i += static_cast<SeqSize_t>(gap);
+            sites.push_back(i);
+            if (++i >= n) break;
+        }
+    }
+    place_heterozygous(sites);
+};
+
+
+// Make the sites in the sorted vector sites heterozygous and the rest
+// homozygous, then bring runs and break weights up to date once.
+
+void
+Chromosome::place_heterozygous(const std::vector<SeqSize_t>& sites)
+{
+    const bool track_runs = _track_runs;
+    const bool dynamic_breaks = _dynamic_breaks;
+    _track_runs = false;
+    _dynamic_breaks = false;
+    fill(HOMZ);
+    if (packed()) {
+        // gather each word's bits and write the word once
+        BitSequence::word_type* w = B.words();
+        const unsigned bits = BitSequence::word_bits;
+        for (size_t k = 0; k < sites.size(); ) {
+            const SeqSize_t word = sites[k] / bits;
+            BitSequence::word_type x = 0;
+            for ( ; k < sites.size() && sites[k] / bits == word; ++k)
+                x |= BitSequence::word_type(1) << (sites[k] % bits);
+            w[word] = x;
+        }
+    } else if (_storage == STORAGE_SPARSE) {
+        H.assign(sites);
+    } else {
+        for (size_t k = 0; k < sites.size(); ++k) set_site(sites[k], HETZ);
+    }
+    _track_runs = track_runs;
+    _dynamic_breaks = dynamic_breaks;
+    if (_track_runs) rebuild_runs();
+    if (_dynamic_breaks) rebuild_break_weights();
+};
+
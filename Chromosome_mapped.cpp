@@ -0,0 +1,154 @@
+#include "Chromosome.h"
+
+#include <cstring>
+
+/*! Methods implementing memory-mapped sequence storage.
+
+  @sa set_storage_mapped open_mapped
+
+  An image file is laid out as:
+
+      offset  size
+      0       8      magic "CHROMSEQ"
+      8       4      format version, image_version
+      12      4      size of this header in bytes, 40
+      16      8      number of sites, _nbp
+      24      8      byte offset of the sequence section, the page size
+      32      8      number of 64-bit words in the sequence section
+      ...            zero padding to the sequence section
+      offset  ...    sequence section
+
+  The sequence section holds the sequence bit-packed as in BitSequence, and
+  B uses it in place.  Values are in native byte order.  Sites are read and
+  written at random as mutations and breaks land, so the mapping is
+  advised for random access except during whole-sequence scans.
+ */
+
+namespace {
+
+    const char     image_magic[8] = { 'C', 'H', 'R', 'O', 'M', 'S', 'E', 'Q' };
+    const uint32_t image_version = 1;
+
+    struct ImageHeader {
+        char      magic[8];
+        uint32_t  version;
+        uint32_t  header_size;
+        uint64_t  nbp;
+        uint64_t  sequence_offset;
+        uint64_t  sequence_words;
+    };
+
+}  // anonymous namespace
+
+
+/*! Write the current sequence to a new image file and use it for B.
+ */
+bool
+Chromosome::map_image(const std::string& filename)
+{
+    _trace("map_image ( filename )");
+
+    const uint64_t offset = MappedFile::page_size();
+    const uint64_t words = BitSequence::words_for_size(get_nbp());
+    const size_t word_size = sizeof(BitSequence::word_type);
+
+    BitSequence packed_copy;
+    const BitSequence* seq = &B;
+    if (! packed()) {
+        copy_to_bits(packed_copy);
+        seq = &packed_copy;
+    }
+    assert(seq->size() == get_nbp());
+
+    // map the new image alongside the old, which B may still be using
+    MappedFile image;
+    if (! image.open(filename, offset + words * word_size)) return(false);
+    ImageHeader h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, image_magic, sizeof(h.magic));
+    h.version = image_version;
+    h.header_size = sizeof(ImageHeader);
+    h.nbp = get_nbp();
+    h.sequence_offset = offset;
+    h.sequence_words = words;
+    memset(image.data(), 0, offset);
+    memcpy(image.data(), &h, sizeof(h));
+    BitSequence::word_type* w = 
+        reinterpret_cast<BitSequence::word_type*>(image.data() + offset);
+    if (words) memcpy(w, seq->words(), words * word_size);
+
+    B.attach(w, get_nbp());
+    Map.swap(image);
+    Map.advise(MappedFile::ADVISE_RANDOM);
+    _mapped_filename = filename;
+    return(true);
+};
+
+
+void
+Chromosome::unmap_image()
+{
+    _trace("unmap_image ( )");
+    B.detach();
+    Map.close();
+};
+
+
+bool
+Chromosome::set_storage_mapped(const std::string& filename)
+{
+    _trace("set_storage_mapped ( filename )");
+    if (_storage == STORAGE_MAPPED) return(map_image(filename));
+    _mapped_filename = filename;
+    set_storage(STORAGE_MAPPED);
+    return(_storage == STORAGE_MAPPED);
+};
+
+
+/*! Use the sequence in an existing image file, replacing the current
+    sequence and its length.
+ */
+bool
+Chromosome::open_mapped(const std::string& filename)
+{
+    _trace("open_mapped ( filename )");
+
+    MappedFile image;
+    if (! image.open(filename)) return(false);
+    ImageHeader h;
+    bool ok = (image.size() >= sizeof(h));
+    if (ok) {
+        memcpy(&h, image.data(), sizeof(h));
+        ok = (memcmp(h.magic, image_magic, sizeof(h.magic)) == 0) &&
+             h.version == image_version && h.header_size == sizeof(h) &&
+             h.sequence_words == BitSequence::words_for_size(h.nbp) &&
+             h.sequence_offset % sizeof(BitSequence::word_type) == 0 &&
+             image.size() >= h.sequence_offset + 
+                             h.sequence_words * sizeof(BitSequence::word_type);
+    }
+    if (! ok) {
+        std::cerr << "Chromosome::open_mapped : " << filename 
+            << " is not a sequence image" << std::endl;
+        return(false);
+    }
+
+    // release the old storage, then take up the image
+    if (_storage == STORAGE_VECTOR) sequence_type().swap(X);
+    else if (_storage == STORAGE_SPARSE) H.clear();
+    set_nbp(h.nbp);
+    B.attach(reinterpret_cast<BitSequence::word_type*>(image.data() + 
+                                                       h.sequence_offset), 
+             h.nbp);
+    Map.swap(image);
+    Map.advise(MappedFile::ADVISE_RANDOM);
+    _mapped_filename = filename;
+    _storage = STORAGE_MAPPED;
+    // as init() would for the new length and sequence
+    if (MutateMap.size() != get_nbp()) MutateMap.clear();
+    if (DSBreakMap.size() != get_nbp()) DSBreakMap.clear();
+    if (_track_runs) rebuild_runs();
+    if (_dynamic_breaks) rebuild_break_weights();
+    unschedule();
+    return(true);
+};
+
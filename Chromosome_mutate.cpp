@@ -12,7 +12,8 @@ Chromosome::mutate()
     //    eventually have to expand this to >1 events per tick if number of sites
     //    gets big enough.
     // 2  Determine the site at which it occurred, via a draw from a uniform
-    //    distribution multiplied by number of sites then rounded down.
+    //    distribution multiplied by number of sites then rounded down, or
+    //    from the rate map if there is one.
     // 3a If the affected site was homozygous, make it heterozygous, and DONE.
     // 3b If the affected site was heterozygous, it has a 1/3 chance of turning
     //    homozygous ...
@@ -22,30 +23,48 @@ Chromosome::mutate()
     // 5  Otherwise, leave site heterozygous, and DONE.
     //
 
-    double mut_event_threshold = (get_mu() * get_nbp());  // site rate * num sites
+    double mut_event_threshold = mutate_threshold();  // site rate * num sites
     double event_draw;
-    const double homz_fraction = (1.0/3.0);
     if ((event_draw = mutate_Uniform.draw()) < mut_event_threshold) {
-        SeqSize_t mutsite = static_cast<SeqSize_t>(mutate_Uniform.draw() * get_nbp());
-        bp site_old = X[mutsite];
-        if (is_homozygous(X[mutsite])) { 
-            X[mutsite] = HETZ; 
-        } else {
-            if (event_draw < (mut_event_threshold * homz_fraction)) {
-                X[mutsite] = HOMZ;
-            }
-        }
-        MutationEvent event;
-        event.event = MutationLog.size();
-        event.event_threshold = mut_event_threshold;
-        event.event_draw = event_draw;
-        event.event_site = mutsite;
-        event.val_orig = site_old;
-        event.val_new = X[mutsite];
-        MutationLog.push_back(event);
+        SeqSize_t mutsite = mutate_draw_site();
+        mutate_site(mutsite, event_draw, mut_event_threshold);
         _did_mutate= true;
     } else { 
         _did_mutate = false; 
     }
 };
 
+// Draw the site of a mutation, uniformly or from the rate map.
+
+Chromosome::SeqSize_t
+Chromosome::mutate_draw_site()
+{
+    if (MutateMap.empty())
+        return(static_cast<SeqSize_t>(mutate_Uniform.draw() * get_nbp()));
+    double u_bin = mutate_Uniform.draw();
+    return(MutateMap.sample(u_bin, mutate_Uniform.draw()));
+};
+
+// Apply a mutation at mutsite and log it.  event_draw is the uniform draw
+// below mut_event_threshold that triggered the event; steps 3a-5 above are
+// decided by it.
+
+void
+Chromosome::mutate_site(SeqSize_t mutsite, double event_draw,
+                        double mut_event_threshold)
+{
+    const double homz_fraction = (1.0/3.0);
+    bp site_old = get_site(mutsite);
+    bp site_new = site_old;
+    if (is_homozygous(site_old)) { 
+        site_new = HETZ; 
+    } else {
+        if (event_draw < (mut_event_threshold * homz_fraction)) {
+            site_new = HOMZ;
+        }
+    }
+    if (site_new != site_old) set_site(mutsite, site_new);
+    MutationLog.push(mut_event_threshold, event_draw, mutsite, 
+                     site_old, site_new);
+};
+
@@ -16,12 +16,11 @@ Chromosome::repair0 ( )
 {
     _trace("repair0 ( )");
 
-    const int debug = 1;
+    const int debug = get_debug_repair();
 
     //! We have double-stranded breaks.  We need to go through the
-    //! log and process them en masse... There might be more than one and 
-    //! they might interfere, but that's a sophisticated approach.  I'll
-    //! have to implement different mmr policies, I think.
+    //! log and process them en masse.  Since none of them converts
+    //! anything, there might be more than one and they cannot interfere.
 
     if (DSBreakQueue.size() == 0) { return; }
     if (debug >= 1) {
@@ -33,28 +32,22 @@ Chromosome::repair0 ( )
             DSBreakEvent::print_header(std::cout);
         }
     }
-    // DSBreakDequeI p;
-    // DSBreakDequeCI cp;
     long count = 1;
-    while (DSBreakQueue.size()) {
-        if (count > 1) { 
-            std::cerr << "Chromosome::repair0 : more than one DSB, not implemented"
-                << std::endl;
-            exit(1);
-        }
-        const DSBreakEvent& event = DSBreakQueue.back();
+    for (DSBreakDequeCI p = DSBreakQueue.begin(); p != DSBreakQueue.end(); ++p) {
+        const DSBreakRef& ref = *p;
         if (debug >= 2) {
-            print_centered(std::cout, event.event_site);
+            print_centered(std::cout, ref.event_site);
         }
         if (debug >= 1) {
             std::cout << "repair" << "\t" << count << "\t";
-            event.print(std::cout);
-        }
-        if (event.event_site >= min_DSB_site) {
-            // it is a valid DSB (placeholder), just remove the record
-            DSBreakQueue.pop_back();
+            if (DSBreakLog.resident(ref.event)) 
+                DSBreakLog.get(ref.event).print(std::cout);
+            else 
+                std::cout << "NA\tNA\t" << ref.event_site << std::endl;
         }
         ++count;
     }
+    // they are all valid DSBs (placeholder), just remove the records
+    DSBreakQueue.clear();
 };
 
@@ -1,32 +1,59 @@
 #include "Chromosome.h"
 
+#include <algorithm>
+#include <vector>
+
 /*! Method implementing a naive policy for double-stranded break repair.
 
   @sa repair0
 
   This implements a naive policy for double-stranded break repair, which draws
   a direction of repair from uniform and then draws a conversion tract length
-  from an empirically-determined distribution.  We (will be able to) handle
-  several different tract length distributions.  The one we currently
-  implement is due to Hilliker et al. 1994 Meiotic gene conversion tract
-  length distribution within the rosy locus of Drosophila melanogaster.
-  Genetics 137:1019-1026.
+  from a tract length distribution.  We handle several different tract length
+  distributions, see TractLength: geometric (the default), a two-component
+  geometric mixture, or an empirical table such as that due to Hilliker et al.
+  1994 Meiotic gene conversion tract length distribution within the rosy
+  locus of Drosophila melanogaster.  Genetics 137:1019-1026.
 
   There are several different policies that we need to consider, even within
   this most naive case.  First, what do we do when the conversion tract is
   going to extend past the end of the chromosome?  We can (a) draw tract
   lengths until one does not; (b) kill the chromosome; (c) just convert out to
   the end and leave it at that, effectively truncating the tract to the length
-  of chromosome available for it.
+  of chromosome available for it.  We do (c).
+
+  Second, what do we do when more than one break is queued?  All queued
+  breaks are repaired in one pass.  The breaks are sorted by site, a
+  direction and tract length is drawn for each in that order, and the
+  resulting tracts are merged into disjoint intervals that are then converted
+  in a single left-to-right sweep over the sequence.  Overlapping or abutting
+  tracts are converted as their union: every site covered by any tract is
+  made homozygous, and since conversion to homozygosity does not depend on
+  what was there before, the order in which overlapping tracts are applied
+  cannot matter.
  */
 
+namespace {
+
+    struct Tract {
+        Chromosome::SeqSize_t first, last;  // inclusive
+        bool operator<(const Tract& t) const { return(first < t.first); };
+    };
+
+    struct BreakSiteLess {
+        template<class E>
+        bool operator()(const E& a, const E& b) const
+        { return(a.event_site < b.event_site); };
+    };
+
+}
+
 void 
 Chromosome::repair1 ( )
 {
     _trace("repair1 ( )");
 
-    const int debug = 1;
-    bool      truncated = false;
+    const int debug = get_debug_repair();
 
     if (DSBreakQueue.size() == 0) { return; }
     if (debug > 1) {
@@ -35,57 +62,65 @@ Chromosome::repair1 ( )
         std::cout << "action\titer_event\t";
         DSBreakEvent::print_header(std::cout);
     }
-    // DSBreakDequeI p;
-    // DSBreakDequeCI cp;
-    long count = 1;
-    while (DSBreakQueue.size()) {
-        if (count >= 2) { 
-            std::cerr << "Chromosome::repair1 : more than one DSB, not implemented"
-                << std::endl;
-            exit(1);
-        }
-        DSBreakEvent& event = DSBreakQueue.back();
+
+    // stable, so breaks at the same site keep the order they occurred in
+    std::stable_sort(DSBreakQueue.begin(), DSBreakQueue.end(), BreakSiteLess());
+
+    std::vector<Tract> tracts;
+    tracts.reserve(DSBreakQueue.size());
+    for (DSBreakDequeI p = DSBreakQueue.begin(); p != DSBreakQueue.end(); ++p) {
+        // direction and length are drawn here and not logged
+        DSBreakEvent event;
+        event.event = p->event;
+        event.event_site = p->event_site;
         if (debug >= 2) {
             print_centered(std::cout, event.event_site);
         }
-        if (event.event_site >= min_DSB_site) {
-            // it is a valid DSB (placeholder)
-            
-            event.event_dir = (repair1_Uniform.draw() < 0.5) ? (-1) : (1);
-            event.event_length = repair1_Geometric.draw();
-            if (event.event_length > 0) {
-                SeqSize_t tract_end = event.event_site + 
-                                      (event.event_length * event.event_dir);
-                // truncate the end of the tract to the end of the chromosome
-                if (tract_end < 0) { 
-                    tract_end = 0; 
-                    truncated = true;
-                } else if (tract_end >= get_nbp()) { 
-                    tract_end = get_nbp() - 1; 
-                    truncated = true; 
-                }
-                for (SeqSize_t i = event.event_site; i != tract_end; i += event.event_dir) {
-                    X[i] = HOMZ;
-                }
-                X[tract_end] = HOMZ;
-                if (debug >= 1) {
-                    std::cout << "Chromosome::repair1 : site = " 
-                        << event.event_site 
-                        << (event.event_dir > 0 ? " > " : " < ")
-                        << tract_end 
-                        << "  length = " << event.event_dir * long(event.event_length)
-                        << "  truncated = " << truncated
-                        << std::endl;
-                    if (debug > 1) {
-                        print_centered(std::cout, event.event_site,
-                                       event.event_dir * long(event.event_length));
-                        std::cout << std::endl;
-                    }
-                }
+        if (event.event_site < min_DSB_site) continue;  // not a valid DSB
+        bool truncated = false;
+        event.event_dir = (repair1_Uniform.draw() < 0.5) ? (-1) : (1);
+        event.event_length = repair1_Tract.draw();
+        if (event.event_length <= 0) continue;
+        // signed, so a leftward tract can run off the start
+        SeqTract_t tract_end = SeqTract_t(event.event_site) + 
+                              (event.event_length * event.event_dir);
+        // truncate the end of the tract to the end of the chromosome
+        if (tract_end < 0) { 
+            tract_end = 0; 
+            truncated = true;
+        } else if (tract_end >= SeqTract_t(get_nbp())) { 
+            tract_end = get_nbp() - 1; 
+            truncated = true; 
+        }
+        Tract t;
+        t.first = VectorUtility::Min(event.event_site, SeqSize_t(tract_end));
+        t.last = VectorUtility::Max(event.event_site, SeqSize_t(tract_end));
+        tracts.push_back(t);
+        if (debug >= 1) {
+            std::cout << "Chromosome::repair1 : site = " 
+                << event.event_site 
+                << (event.event_dir > 0 ? " > " : " < ")
+                << tract_end 
+                << "  length = " << event.event_dir * long(event.event_length)
+                << "  truncated = " << truncated
+                << std::endl;
+            if (debug > 1) {
+                print_centered(std::cout, event.event_site,
+                               event.event_dir * long(event.event_length));
+                std::cout << std::endl;
             }
-            DSBreakQueue.pop_back();
         }
-        ++count;
+    }
+    DSBreakQueue.clear();
+
+    // merge into disjoint intervals and convert them left to right
+    std::sort(tracts.begin(), tracts.end());
+    size_t i = 0;
+    while (i < tracts.size()) {
+        Tract merged = tracts[i];
+        for (++i; i < tracts.size() && tracts[i].first <= merged.last + 1; ++i)
+            merged.last = VectorUtility::Max(merged.last, tracts[i].last);
+        set_tract(merged.first, merged.last, HOMZ);
     }
 };
 
@@ -0,0 +1,81 @@
+#include "Chromosome.h"
+
+/*! Method driving a run of the event-driven simulation, with monitoring.
+
+  @sa step EquilibriumMonitor TimeSeries
+
+  The state of the chromosome only changes at events, so between events we
+  need not visit each sample tick: all the sample ticks before the next
+  event see the current state, and are handed to the monitor at once.  The
+  sample at an event's own tick sees the state after the event and its
+  repair.  Time series samples every so many ticks are handled the same
+  way, though each gets its own record; samples every so many events are
+  taken after the event and its repair.
+ */
+
+Chromosome::Tick_t
+Chromosome::run(Tick_t max_ticks)
+{
+    _trace("run ( max_ticks )");
+
+    const Tick_t start = _tick;
+    const Tick_t end = (max_ticks >= never - _tick) ? never : _tick + max_ticks;
+    bool stop = false;
+    while (_tick < end && ! stop) {
+        Tick_t next = next_event_tick();
+        // samples at ticks before next, and at end if no event precedes it
+        Tick_t upto = VectorUtility::Min(next - 1, end);
+        if (_monitor_on && ! Monitor.stopped()) {
+            const Tick_t interval = Monitor.get_sample_interval();
+            if (_next_sample_tick <= upto) {
+                long n = (upto - _next_sample_tick) / interval + 1;
+                // the monitor may stop before taking them all
+                n = Monitor.observe(heterozygosity(), mean_homozygous_run(), n);
+                _next_sample_tick += n * interval;
+            }
+            if (Monitor.stopped()) {
+                // no event lies between here and the last sample tick
+                _tick = VectorUtility::Max(_tick, _next_sample_tick - interval);
+                upto = _tick;
+                stop = true;
+            }
+        }
+        if (Series.is_open() && 
+            Series.get_interval_type() == TimeSeries::EVERY_TICKS &&
+            _next_series_tick <= upto) {
+            TimeSeries::Sample s = get_sample();
+            for ( ; _next_series_tick <= upto; 
+                 _next_series_tick += Series.get_interval()) {
+                s.tick = _next_series_tick;
+                Series.record(s);
+            }
+        }
+        if (stop) break;
+        if (next > end) { _tick = end; break; }
+        step();
+        repair1();
+        if (Series.is_open() && 
+            Series.get_interval_type() == TimeSeries::EVERY_EVENTS &&
+            number_mutations() + number_dsbreaks() >= _next_series_event) {
+            Series.record(get_sample());
+            const long events = number_mutations() + number_dsbreaks();
+            while (_next_series_event <= events)
+                _next_series_event += Series.get_interval();
+        }
+    }
+    return(_tick - start);
+};
+
+Chromosome::Tick_t
+Chromosome::next_event_tick()
+{
+    _trace("next_event_tick ( )");
+    if (_next_mutate_tick == unscheduled)
+        _next_mutate_tick = schedule(mutate_Uniform, 
+                                     VectorUtility::Min(mutate_threshold(), 1.0));
+    if (_next_break_tick == unscheduled)
+        _next_break_tick = schedule(dsbreak_Uniform,
+                                    VectorUtility::Min(dsbreak_threshold(), 1.0));
+    return(VectorUtility::Min(_next_mutate_tick, _next_break_tick));
+};
+
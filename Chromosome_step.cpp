@@ -0,0 +1,84 @@
+#include "Chromosome.h"
+
+/*! Method implementing the event-driven (waiting-time) simulation engine.
+
+  @sa mutate dsbreak
+
+  Calling mutate() and dsbreak() once per tick makes a Bernoulli trial each
+  tick with success probability mutate_threshold() and dsbreak_threshold(),
+  respectively.  For realistic rates nearly all of these trials fail.  The
+  number of ticks up to and including the next success of a Bernoulli process
+  is geometric, so we draw that waiting time directly for each kind of event
+  and jump to whichever comes first.  Both kinds of event can fall on the same
+  tick; as with the per-tick loop, the mutation is applied first.
+
+  Conditional on an event occurring on a tick, the per-tick event draw is
+  uniform below the threshold, so we recreate it for the event logs and for
+  the homozygous-making decision in mutate_site() from a fresh uniform.  Event
+  rates are capped at one per tick, as they are in the per-tick model.
+
+  By memorylessness, a schedule can be redrawn from the current tick at any
+  time without changing the distribution of events, which is what happens
+  after the rates or the chromosome change (see unschedule()).
+ */
+
+Chromosome::Tick_t
+Chromosome::step()
+{
+    _trace("step ( )");
+
+    const double mut_event_threshold = mutate_threshold();
+    double break_event_threshold = dsbreak_threshold();
+    const double mut_p = VectorUtility::Min(mut_event_threshold, 1.0);
+    double break_p = VectorUtility::Min(break_event_threshold, 1.0);
+
+    Tick_t next = next_event_tick();
+    if (next == never) {
+        _did_mutate = false;
+        _did_break = false;
+        return(0);
+    }
+    Tick_t elapsed = next - _tick;
+    _tick = next;
+
+    // with sequence-dependent break rates the mutation may reschedule the
+    // break, so decide both before applying either
+    _did_mutate = (_next_mutate_tick == next);
+    _did_break = (_next_break_tick == next);
+    if (_did_mutate) {
+        SeqSize_t mutsite = mutate_draw_site();
+        double event_draw = mutate_Uniform.draw() * mut_p;
+        mutate_site(mutsite, event_draw, mut_event_threshold);
+        _next_mutate_tick = schedule(mutate_Uniform, mut_p);
+    }
+
+    if (_did_break) {
+        // the break site is drawn from the weights after the mutation, so
+        // its threshold and the next schedule must be too
+        if (_did_mutate && _dynamic_breaks) {
+            break_event_threshold = dsbreak_threshold();
+            break_p = VectorUtility::Min(break_event_threshold, 1.0);
+        }
+        SeqSize_t breaksite = dsbreak_draw_site();
+        double event_draw = dsbreak_Uniform.draw() * break_p;
+        dsbreak_site(breaksite, event_draw, break_event_threshold);
+        _next_break_tick = schedule(dsbreak_Uniform, break_p);
+    }
+
+    return(elapsed);
+};
+
+// Return the tick of the next success of a Bernoulli process with per-tick
+// success probability p, starting after the current tick, or never if p is 0.
+
+Chromosome::Tick_t
+Chromosome::schedule(RandUniformPool& unif, double p) const
+{
+    if (p <= 0.0) { return(never); }
+    if (p >= 1.0) { return(_tick + 1); }
+    // number of failures before the first success; 1 - draw() is in (0, 1]
+    double k = floor(log(1.0 - unif.draw()) / log1p(-p));
+    if (k >= static_cast<double>(never - _tick - 1)) { return(never); }
+    return(_tick + 1 + static_cast<Tick_t>(k));
+};
+
@@ -0,0 +1,218 @@
+#ifndef EQUILIBRIUMMONITOR_H
+#define EQUILIBRIUMMONITOR_H
+
+#include <cmath>
+#include <iostream>
+#include "Checkpoint.h"
+
+/*! @class Welford
+
+    @brief Streaming weighted mean and variance.
+
+    West 1979 Updating mean and variance estimates: an improved method.
+    Communications of the ACM 22:532-535.  A value added with weight w
+    counts as w identical observations.
+ */
+class Welford {
+    private:
+        double  _weight;  // total weight, the number of observations
+        double  _mean;
+        double  _m2;      // sum of weighted squared deviations from mean
+    public:
+        Welford() : _weight(0.0), _mean(0.0), _m2(0.0) { };
+        void   clear() { _weight = 0.0; _mean = 0.0; _m2 = 0.0; };
+        void
+        add(const double x, const double w = 1.0)
+        {
+            if (w <= 0.0) return;
+            _weight += w;
+            double delta = x - _mean;
+            _mean += (w / _weight) * delta;
+            _m2 += w * delta * (x - _mean);
+        };
+        double count() const  { return(_weight); };
+        double mean() const   { return(_mean); };
+        //! sample variance, SS/(n-1)
+        double var() const    { return(_weight > 1.0 ? _m2 / (_weight - 1.0) : 0.0); };
+};
+
+/*! @class EquilibriumMonitor
+
+    @brief Decide online when a simulation has reached dynamic equilibrium.
+
+    The monitor is fed the heterozygosity (fraction of heterozygous sites)
+    and the mean length of runs of homozygosity every sample_interval ticks.
+    Samples are gathered into consecutive windows of window samples each,
+    with a Welford mean and variance of each statistic per window.  When a
+    window fills it is compared with the one before it: the window passes if,
+    for both statistics, the difference between the window means is within
+
+        rel_tol * |previous mean|  +  z * (standard error of the difference)
+
+    Windows that pass num_passes times in a row mark equilibrium.  The
+    standard error treats samples as independent, which they are not, so
+    rel_tol should not be set to 0.
+
+    On equilibrium the monitor either asks for the run to stop (STOP) or
+    moves to a sampling phase (SAMPLE) in which it accumulates the mean and
+    variance of both statistics at equilibrium.  See Chromosome::run().
+ */
+class EquilibriumMonitor {
+
+    public:
+
+        enum action_type { STOP = 0, SAMPLE = 1 };
+        enum phase_type  { BURNIN = 0, SAMPLING = 1, STOPPED = 2 };
+
+    private:
+
+        long         _sample_interval;  // ticks between samples
+        long         _window;           // samples per window
+        double       _rel_tol;
+        double       _z;
+        int          _num_passes;       // consecutive passes needed
+        action_type  _action;
+
+        phase_type   _phase;
+        long         _num_samples;
+        long         _equilibrium_sample;  // sample at which equilibrium was reached
+        int          _passes;
+        bool         _have_prev;
+        Welford      CurHet, CurRun, PrevHet, PrevRun;
+        Welford      EqHet, EqRun;      // during SAMPLING
+
+        static bool
+        close(const Welford& cur, const Welford& prev, double rel_tol, double z)
+        {
+            double se = sqrt(cur.var() / cur.count() + prev.var() / prev.count());
+            return(fabs(cur.mean() - prev.mean()) <= 
+                   rel_tol * fabs(prev.mean()) + z * se);
+        };
+
+        void
+        end_window()
+        {
+            if (_have_prev) {
+                if (close(CurHet, PrevHet, _rel_tol, _z) && 
+                    close(CurRun, PrevRun, _rel_tol, _z)) ++_passes;
+                else _passes = 0;
+                if (_passes >= _num_passes) {
+                    _equilibrium_sample = _num_samples;
+                    _phase = (_action == STOP) ? STOPPED : SAMPLING;
+                }
+            }
+            PrevHet = CurHet; PrevRun = CurRun;
+            CurHet.clear(); CurRun.clear();
+            _have_prev = true;
+        };
+
+    public:
+
+        /*! constructor
+
+            @param si   ticks between samples
+            @param w    samples per window
+            @param rt   relative tolerance between window means
+            @param z    standard errors of tolerance between window means
+            @param np   consecutive passing windows needed
+            @param a    what to do at equilibrium, STOP or SAMPLE
+         */
+        EquilibriumMonitor(long si = 1000, long w = 100, double rt = 0.01,
+                           double z = 2.0, int np = 3, action_type a = STOP)
+        { configure(si, w, rt, z, np, a); };
+
+        //! Set parameters and start over in BURNIN
+        void
+        configure(long si, long w, double rt, double z, int np, action_type a)
+        {
+            _sample_interval = (si > 0) ? si : 1;
+            _window = (w > 1) ? w : 2;
+            _rel_tol = rt;
+            _z = z;
+            _num_passes = (np > 0) ? np : 1;
+            _action = a;
+            reset();
+        };
+
+        void
+        reset()
+        {
+            _phase = BURNIN;
+            _num_samples = 0;
+            _equilibrium_sample = -1;
+            _passes = 0;
+            _have_prev = false;
+            CurHet.clear(); CurRun.clear(); PrevHet.clear(); PrevRun.clear();
+            EqHet.clear(); EqRun.clear();
+        };
+
+        /*! Add n samples of the same state, as when several sample ticks
+            pass between events
+
+            @param het       heterozygosity
+            @param mean_run  mean length of runs of homozygosity
+            @param n         number of samples
+            @return          number of samples taken, fewer than n if the
+                             monitor stops part way through them
+         */
+        long
+        observe(double het, double mean_run, long n = 1)
+        {
+            const long first = _num_samples;
+            while (n > 0 && _phase != STOPPED) {
+                if (_phase == SAMPLING) {
+                    EqHet.add(het, n);
+                    EqRun.add(mean_run, n);
+                    _num_samples += n;
+                    break;
+                }
+                long k = _window - long(CurHet.count());
+                if (k > n) k = n;
+                CurHet.add(het, k);
+                CurRun.add(mean_run, k);
+                _num_samples += k;
+                n -= k;
+                if (long(CurHet.count()) == _window) end_window();
+            }
+            return(_num_samples - first);
+        };
+
+        long         get_sample_interval() const { return(_sample_interval); };
+        phase_type   get_phase() const           { return(_phase); };
+        bool         at_equilibrium() const      { return(_phase != BURNIN); };
+        bool         stopped() const             { return(_phase == STOPPED); };
+        long         num_samples() const         { return(_num_samples); };
+        //! ticks of burn-in, or -1 if not yet at equilibrium
+        long
+        equilibrium_tick() const
+        { return(_equilibrium_sample < 0 ? -1 : 
+                 _equilibrium_sample * _sample_interval); };
+        //! statistics at equilibrium, from the sampling phase
+        const Welford& equilibrium_het() const   { return(EqHet); };
+        const Welford& equilibrium_run() const   { return(EqRun); };
+
+        void
+        print(std::ostream& os = std::cout) const
+        {
+            os << "EquilibriumMonitor: phase = " 
+                << (_phase == BURNIN ? "burnin" : 
+                    (_phase == SAMPLING ? "sampling" : "stopped"))
+                << "  samples = " << _num_samples
+                << "  equilibrium_tick = " << equilibrium_tick();
+            if (_phase == SAMPLING)
+                os << "  het = " << EqHet.mean() << " (" << EqHet.var() << ")"
+                    << "  mean_run = " << EqRun.mean() << " (" << EqRun.var() << ")";
+            os << std::endl;
+        };
+
+        // parameters and progress, for checkpoints
+        void
+        save_state(std::ostream& os) const
+        { Checkpoint::write(os, *this); };
+
+        bool
+        load_state(std::istream& is)
+        { return(Checkpoint::read(is, *this)); };
+};
+
+#endif // EQUILIBRIUMMONITOR_H
@@ -0,0 +1,255 @@
+#ifndef EVENTLOG_H
+#define EVENTLOG_H
+
+#include <vector>
+#include <string>
+#include <fstream>
+#include <iostream>
+#include <cstddef>
+#include <stdint.h>
+#include <unistd.h>
+#include "Checkpoint.h"
+
+/*! @class EventLog
+
+    @brief Bookkeeping for a log of numbered events held as columns.
+
+    Events are numbered from 0 in the order they are recorded.  A derived
+    class holds one std::vector per event field (structure-of-arrays) and
+    fills slot append_slot() of each when recording an event.  How many
+    events are kept depends on the mode:
+
+      LOG_ALL     every event is kept in memory (the default)
+      LOG_OFF     events are counted but not kept
+      LOG_RING    the most recent capacity events are kept, older events
+                  are overwritten
+      LOG_STREAM  events are buffered in blocks of capacity events, each
+                  full block is appended to a binary file and the buffer
+                  reused; the last, partial, block is written by flush()
+
+    set_mode() discards the events held in memory, so whatever the mode no
+    event recorded before the last set_mode() is resident.
+
+    Except for LOG_ALL, memory use is fixed regardless of the number of
+    events.  Each block in a stream file is written as the 64-bit number of
+    its first event, the 64-bit number of events n in the block, then each
+    column in turn as n raw values of its type, in native byte order.
+ */
+class EventLog {
+
+    public:
+
+        enum log_mode { LOG_ALL = 0, LOG_OFF = 1, LOG_RING = 2, LOG_STREAM = 3 };
+
+        static const size_t npos = static_cast<size_t>(-1);
+
+    private:
+
+        log_mode       _mode;
+        size_t         _capacity;     // LOG_RING and LOG_STREAM
+        long           _count;        // events recorded
+        long           _block_first;  // first event recorded since set_mode(),
+                                      // LOG_STREAM, first event in buffer
+        std::string    _filename;     // LOG_STREAM
+        std::ofstream  _file;
+        uint64_t       _file_size;    // LOG_STREAM, bytes of blocks written
+
+        EventLog(const EventLog&);             // not copyable, owns a file
+        EventLog& operator=(const EventLog&);
+
+        void
+        write_block()
+        {
+            const size_t n = _count - _block_first;
+            if (n == 0) return;
+            Checkpoint::write(_file, static_cast<uint64_t>(_block_first));
+            Checkpoint::write(_file, static_cast<uint64_t>(n));
+            write_columns(_file, n);
+            _file.flush();
+            if (! _file) {
+                std::cerr << "EventLog : error writing " << _filename << std::endl;
+            }
+            _file_size = _file.tellp();
+        };
+
+        // when appending, blocks past _file_size are cut off first
+        void
+        open(const bool append)
+        {
+            if (append && truncate(_filename.c_str(), _file_size) != 0) {
+                std::cerr << "EventLog : cannot truncate " << _filename 
+                    << ", logging off" << std::endl;
+                _mode = LOG_OFF;
+                return;
+            }
+            _file.open(_filename.c_str(), std::ios::binary | 
+                       (append ? std::ios::app | std::ios::ate : std::ios::trunc));
+            if (! _file) {
+                std::cerr << "EventLog : cannot open " << _filename 
+                    << ", logging off" << std::endl;
+                _mode = LOG_OFF;
+            }
+            if (! append) _file_size = 0;
+        };
+
+    protected:
+
+        //! Resize every column to hold n events
+        virtual void resize_columns(const size_t n) = 0;
+        //! Write the first n entries of each column in turn
+        virtual void write_columns(std::ostream& os, const size_t n) const = 0;
+        //! Read n entries into each column in turn
+        virtual bool read_columns(std::istream& is, const size_t n) = 0;
+
+        /*! Count a new event and return the slot in which to store its
+            fields, or npos if it is not to be stored
+         */
+        size_t
+        append_slot()
+        {
+            size_t slot = npos;
+            switch (_mode) {
+                case LOG_ALL:
+                    slot = _count - _block_first;
+                    resize_columns(slot + 1);
+                    break;
+                case LOG_RING:
+                    slot = _count % _capacity;
+                    break;
+                case LOG_STREAM:
+                    if (static_cast<size_t>(_count - _block_first) == _capacity) {
+                        write_block();
+                        _block_first = _count;
+                    }
+                    slot = _count - _block_first;
+                    break;
+                case LOG_OFF:
+                default:
+                    break;
+            }
+            ++_count;
+            return(slot);
+        };
+
+    public:
+
+        EventLog() 
+            : _mode(LOG_ALL), _capacity(0), _count(0), _block_first(0),
+              _file_size(0)
+        { /* empty */ };
+
+        virtual ~EventLog() { /* derived destructors call close() */ };
+
+        /*! Set the logging mode, discarding events held in memory
+
+            @param m          mode
+            @param capacity   events kept for LOG_RING, block size for LOG_STREAM
+            @param filename   file to write for LOG_STREAM
+         */
+        void
+        set_mode(const log_mode m, const size_t capacity = 0,
+                 const std::string& filename = "")
+        {
+            close();
+            _mode = m;
+            _capacity = capacity;
+            _filename = filename;
+            _block_first = _count;
+            if ((m == LOG_RING || m == LOG_STREAM) && capacity == 0) {
+                std::cerr << "EventLog::set_mode : capacity must be > 0" << std::endl;
+                _mode = LOG_OFF;
+            }
+            resize_columns(_mode == LOG_RING || _mode == LOG_STREAM ? _capacity : 0);
+            if (_mode == LOG_STREAM) open(false);
+        };
+
+        log_mode    get_mode() const     { return(_mode); };
+        size_t      get_capacity() const { return(_capacity); };
+
+        //! Number of events recorded, whether or not they are kept
+        long        count() const        { return(_count); };
+
+        //! Number of the oldest event still held in memory
+        long
+        first_resident() const
+        {
+            switch (_mode) {
+                case LOG_ALL:    return(_block_first);
+                case LOG_RING:   return(_count - _block_first > long(_capacity) ? 
+                                        _count - long(_capacity) : _block_first);
+                case LOG_STREAM: return(_block_first);
+                case LOG_OFF:
+                default:         return(_count);
+            }
+        };
+
+        bool
+        resident(const long e) const
+        { return(e >= first_resident() && e < _count); };
+
+        //! Slot holding event e, which must be resident
+        size_t
+        slot(const long e) const
+        {
+            if (_mode == LOG_RING) return(e % _capacity);
+            return(e - _block_first);
+        };
+
+        //! Write buffered events to the stream file and close it
+        void
+        close()
+        {
+            if (_mode == LOG_STREAM && _file.is_open()) {
+                write_block();
+                _block_first = _count;
+                _file.close();
+            }
+        };
+
+        // mode, counts and events held in memory, for checkpoints; events
+        // already written to a stream file stay there, and resume() after
+        // load_state() cuts the file back to its length at the checkpoint,
+        // dropping any blocks written since, and reopens it for appending
+        void
+        save_state(std::ostream& os) const
+        {
+            Checkpoint::write(os, int(_mode));
+            Checkpoint::write(os, static_cast<uint64_t>(_capacity));
+            Checkpoint::write(os, _count);
+            Checkpoint::write(os, _block_first);
+            Checkpoint::write(os, _file_size);
+            Checkpoint::write(os, static_cast<uint64_t>(_filename.size()));
+            os.write(_filename.data(), _filename.size());
+            size_t n = (_mode == LOG_ALL) ? _count - _block_first : 
+                       (_mode == LOG_OFF) ? 0 : _capacity;
+            write_columns(os, n);
+        };
+
+        bool
+        load_state(std::istream& is)
+        {
+            close();
+            int m;
+            uint64_t cap, len;
+            if (! (Checkpoint::read(is, m) && Checkpoint::read(is, cap) &&
+                   Checkpoint::read(is, _count) && 
+                   Checkpoint::read(is, _block_first) &&
+                   Checkpoint::read(is, _file_size) &&
+                   Checkpoint::read(is, len))) return(false);
+            _mode = log_mode(m);
+            _capacity = cap;
+            _filename.resize(len);
+            if (len && ! is.read(&_filename[0], len)) return(false);
+            size_t n = (_mode == LOG_ALL) ? _count - _block_first : 
+                       (_mode == LOG_OFF) ? 0 : _capacity;
+            resize_columns(n);
+            return(read_columns(is, n));
+        };
+
+        //! Reopen the stream file of a log restored by load_state()
+        void
+        resume()
+        { if (_mode == LOG_STREAM && ! _file.is_open()) open(true); };
+};
+
+#endif // EVENTLOG_H
@@ -0,0 +1,160 @@
+#ifndef FENWICKSAMPLER_H
+#define FENWICKSAMPLER_H
+
+#include <vector>
+#include <cstddef>
+#include <cassert>
+#include <iostream>
+#include <cstdlib>
+#include "Checkpoint.h"
+
+/*! @class FenwickSampler
+
+    @brief Sampling of an index in proportion to weights that change.
+
+    A Fenwick (binary indexed) tree of partial sums of the weights:
+    Fenwick 1994 A new data structure for cumulative frequency tables.
+    Software: Practice and Experience 24:327-336.  Changing one weight and
+    sampling an index each take O(log n); building from n weights is O(n).
+    Where AliasTable must be rebuilt whenever a weight changes, this suits
+    weights that change with every event.
+
+    Sums of weights are kept up to date by adding differences, so rounding
+    error accumulates; the tree is rebuilt from the weights themselves after
+    every n changes, which keeps the cost O(1) per change on average.
+ */
+class FenwickSampler {
+
+    private:
+
+        std::vector<double>   W;      // weight of each index
+        std::vector<double>   Tree;   // Tree[k] sums W over (k - lowbit(k), k]
+        size_t                _top;   // highest power of 2 <= size()
+        size_t                _changes;  // since the last rebuild
+
+        static size_t  lowbit(size_t k) { return(k & (~k + 1)); };
+
+        void
+        rebuild()
+        {
+            const size_t n = W.size();
+            Tree.assign(n + 1, 0.0);
+            for (size_t k = 1; k <= n; ++k) {
+                Tree[k] += W[k - 1];
+                size_t parent = k + lowbit(k);
+                if (parent <= n) Tree[parent] += Tree[k];
+            }
+            _changes = 0;
+        };
+
+    public:
+
+        FenwickSampler() : _top(0), _changes(0) { Tree.assign(1, 0.0); };
+
+        size_t  size() const    { return(W.size()); };
+        bool    empty() const   { return(W.empty()); };
+        double  weight(const size_t i) const  { return(W[i]); };
+
+        void
+        clear()
+        {
+            W.clear();
+            Tree.assign(1, 0.0);
+            _top = 0;
+            _changes = 0;
+        };
+
+        //! (Re)build from a vector of non-negative weights
+        void
+        build(const std::vector<double>& weights)
+        {
+            W = weights;
+            for (size_t i = 0; i < W.size(); ++i) {
+                if (W[i] < 0.0) {
+                    std::cerr << "FenwickSampler::build : negative weight" << std::endl;
+                    exit(1);
+                }
+            }
+            for (_top = 1; _top <= W.size() / 2; _top <<= 1) ;
+            if (W.empty()) _top = 0;
+            rebuild();
+        };
+
+        //! Sum of weights [0, i)
+        double
+        prefix(size_t i) const
+        {
+            assert(i <= W.size());
+            double ans = 0.0;
+            for ( ; i > 0; i -= lowbit(i)) ans += Tree[i];
+            return(ans);
+        };
+
+        double  total() const  { return(prefix(W.size())); };
+
+        //! Set the weight of index i, returning whether it changed
+        bool
+        set(const size_t i, const double w)
+        {
+            assert(i < W.size() && w >= 0.0);
+            const double delta = w - W[i];
+            if (delta == 0.0) return(false);
+            W[i] = w;
+            if (++_changes >= W.size()) {
+                rebuild();
+                return(true);
+            }
+            for (size_t k = i + 1; k <= W.size(); k += lowbit(k)) Tree[k] += delta;
+            return(true);
+        };
+
+        /*! Sample an index
+
+            @param u   uniform draw in [0, 1)
+            @return    index i with probability weight(i) / total()
+         */
+        size_t
+        sample(const double u) const
+        {
+            assert(! W.empty());
+            double target = u * total();
+            // descend to the largest k with prefix(k) <= target
+            size_t k = 0;
+            for (size_t step = _top; step > 0; step >>= 1) {
+                if (k + step <= W.size() && Tree[k + step] <= target) {
+                    k += step;
+                    target -= Tree[k];
+                }
+            }
+            // index k has prefix(k) <= u * total < prefix(k + 1), barring
+            // rounding, which can leave us past the last positive weight
+            if (k >= W.size()) k = W.size() - 1;
+            while (k > 0 && W[k] == 0.0) --k;
+            return(k);
+        };
+
+        // weights and sums, for checkpoints
+        void
+        save_state(std::ostream& os) const
+        {
+            Checkpoint::write_vector(os, W);
+            Checkpoint::write_vector(os, Tree);
+            Checkpoint::write(os, static_cast<uint64_t>(_top));
+            Checkpoint::write(os, static_cast<uint64_t>(_changes));
+        };
+
+        bool
+        load_state(std::istream& is)
+        {
+            uint64_t top, changes;
+            if (! (Checkpoint::read_vector(is, W) && Checkpoint::read_vector(is, Tree) &&
+                   Checkpoint::read(is, top) && Checkpoint::read(is, changes) &&
+                   Tree.size() == W.size() + 1)) return(false);
+            _top = top;
+            _changes = changes;
+            return(true);
+        };
+};
+
+#endif // FENWICKSAMPLER_H
+
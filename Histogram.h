@@ -4,33 +4,388 @@
 #include <vector>
 #include <string>
 #include <map>
+#include <limits>
+#include <algorithm>
+#include <thread>
+#include <cstddef>
+#include <cstdlib>
 #include <cassert>
 #include <iostream>
 #include <iomanip>
 #include "VectorUtility.h"
 
+/*! @class HistogramCounts
+
+    @brief Counts of values for Histogram, kept in a std::map.
+
+    This general version suits any value type with operator<.  Values of
+    integral types are counted by the specialisation below.  A value is
+    present once it has been added or touched, even if its count is 0.
+ */
+template<class T_VALUE, class T_COUNT,
+         bool DENSE = std::numeric_limits<T_VALUE>::is_integer>
+class HistogramCounts {
+
+    private:
+
+        std::map<T_VALUE, T_COUNT>  Hist;
+        typedef typename std::map<T_VALUE, T_COUNT>::const_iterator HistCI;
+
+    public:
+
+        size_t  size() const    { return(Hist.size()); };
+        void    clear()         { Hist.clear(); };
+
+        void    add(const T_VALUE& value, const T_COUNT count)
+        { Hist[value] += count; };
+        void    touch(const T_VALUE& value)
+        { Hist[value] += static_cast<T_COUNT>(0); };
+        void    touch_range(const T_VALUE& min, const T_VALUE& max)
+        { for (T_VALUE value = min; value <= max; ++value) touch(value); };
+
+        //! Count each of values [first, first + n)
+        void
+        count(const T_VALUE* first, const size_t n)
+        { for (size_t i = 0; i < n; ++i) Hist[first[i]]++; };
+
+        void
+        merge(const HistogramCounts& o)
+        { for (HistCI p = o.Hist.begin(); p != o.Hist.end(); ++p) add(p->first, p->second); };
+
+        //! Call f(value, count) for each present value, in order
+        template<class F>
+        void
+        for_each(F& f) const
+        { for (HistCI p = Hist.begin(); p != Hist.end(); ++p) f(p->first, p->second); };
+};
+
+/*! @class HistogramCounts<T_VALUE, T_COUNT, true>
+
+    @brief Counts of values of an integral type for Histogram, kept in an
+           array.
+
+    Counts of values within a window of at most max_span consecutive values
+    are kept in an array indexed by value, with a flag for each marking it
+    present; values outside the window are kept in a std::map as in the
+    general version.  The window is placed around the first values counted
+    and widened, geometrically so that values arriving in order do not
+    reallocate it each time, while it can stay within max_span.  Values
+    are kept in the window by their offset in an unsigned 64-bit key order
+    which is the order of the values themselves, so signed and unsigned
+    types are handled alike.
+
+    A block of values that all fall in the window is counted into scratch
+    counters of its own.  When there are many values over a small range,
+    as there are for the two bp states, four sets of counters are used in
+    turn, so that runs of one value increment four different counters and
+    do not wait on one another; the sets are summed afterward.
+ */
+template<class T_VALUE, class T_COUNT>
+class HistogramCounts<T_VALUE, T_COUNT, true> {
+
+    public:
+
+        //! largest window of values kept in the array
+        static const size_t max_span = size_t(1) << 16;
+
+    private:
+
+        typedef unsigned long long  key_type;
+        typedef typename std::map<T_VALUE, T_COUNT>::const_iterator HistCI;
+
+        key_type                    _lo;       // key of Counts[0]
+        std::vector<T_COUNT>        Counts;
+        std::vector<unsigned char>  Present;
+        size_t                      _num_present;  // flags set in Present
+        std::map<T_VALUE, T_COUNT>  Overflow;  // values outside the window
+
+        // order-preserving map of values to keys, flipping the sign bit of
+        // signed values
+        static key_type
+        key(const T_VALUE& v)
+        {
+            const key_type flip = std::numeric_limits<T_VALUE>::is_signed ?
+                                  key_type(1) << 63 : 0;
+            return(static_cast<key_type>(v) ^ flip);
+        };
+        static T_VALUE
+        value(const key_type k)
+        {
+            const key_type flip = std::numeric_limits<T_VALUE>::is_signed ?
+                                  key_type(1) << 63 : 0;
+            return(static_cast<T_VALUE>(k ^ flip));
+        };
+
+        bool
+        in_window(const key_type k) const
+        { return(k >= _lo && k - _lo < Counts.size()); };
+
+        void
+        mark(const size_t i)
+        { if (! Present[i]) { Present[i] = 1; ++_num_present; } };
+
+        // widen the window to hold keys [klo, khi] if it can stay within
+        // max_span, moving any values in the new window out of Overflow
+        bool
+        cover(const key_type klo, const key_type khi)
+        {
+            if (Counts.empty()) {
+                if (khi - klo >= max_span) return(false);
+                _lo = klo;
+                Counts.assign(khi - klo + 1, static_cast<T_COUNT>(0));
+                Present.assign(Counts.size(), 0);
+                absorb();
+                return(true);
+            }
+            const key_type hi = _lo + (Counts.size() - 1);
+            if (klo >= _lo && khi <= hi) return(true);
+            key_type ulo = std::min(klo, _lo), uhi = std::max(khi, hi);
+            if (uhi - ulo >= max_span) return(false);
+            // grow by at least the current span on the side being extended
+            const key_type span = Counts.size();
+            key_type glo = ulo, ghi = uhi;
+            if (klo < _lo) glo = std::min(ulo, _lo >= span ? _lo - span : 0);
+            if (khi > hi) ghi = std::max(uhi, hi <= ~key_type(0) - span ? hi + span
+                                                                        : ~key_type(0));
+            if (ghi - glo < max_span) { ulo = glo; uhi = ghi; }
+            std::vector<T_COUNT> C(uhi - ulo + 1, static_cast<T_COUNT>(0));
+            std::vector<unsigned char> P(C.size(), 0);
+            std::copy(Counts.begin(), Counts.end(), C.begin() + (_lo - ulo));
+            std::copy(Present.begin(), Present.end(), P.begin() + (_lo - ulo));
+            _lo = ulo;
+            Counts.swap(C);
+            Present.swap(P);
+            absorb();
+            return(true);
+        };
+
+        void
+        absorb()
+        {
+            for (typename std::map<T_VALUE, T_COUNT>::iterator p = Overflow.begin();
+                 p != Overflow.end(); ) {
+                const key_type k = key(p->first);
+                if (! in_window(k)) { ++p; continue; }
+                Counts[k - _lo] += p->second;
+                mark(k - _lo);
+                Overflow.erase(p++);
+            }
+        };
+
+        // count values [first, first + n), all within [Counts[lo], Counts[lo + span])
+        void
+        count_window(const T_VALUE* first, const size_t n, const size_t lo,
+                     const size_t span)
+        {
+            const size_t lanes = (span <= 256 && n >= 1024) ? 4 : 1;
+            std::vector<size_t> L(lanes * span, 0);
+            const key_type base = _lo + lo;
+            size_t i = 0;
+            if (lanes == 4) {
+                size_t* L0 = &L[0];
+                size_t* L1 = L0 + span;
+                size_t* L2 = L1 + span;
+                size_t* L3 = L2 + span;
+                for ( ; i + 4 <= n; i += 4) {
+                    ++L0[key(first[i]) - base];
+                    ++L1[key(first[i + 1]) - base];
+                    ++L2[key(first[i + 2]) - base];
+                    ++L3[key(first[i + 3]) - base];
+                }
+            }
+            for ( ; i < n; ++i) ++L[key(first[i]) - base];
+            for (size_t k = 0; k < span; ++k) {
+                size_t s = L[k];
+                for (size_t l = 1; l < lanes; ++l) s += L[l * span + k];
+                if (s == 0) continue;
+                Counts[lo + k] += static_cast<T_COUNT>(s);
+                mark(lo + k);
+            }
+        };
+
+    public:
+
+        HistogramCounts() : _lo(0), _num_present(0) { };
+
+        size_t  size() const    { return(_num_present + Overflow.size()); };
+
+        void
+        clear()
+        {
+            _lo = 0;
+            Counts.clear();
+            Present.clear();
+            _num_present = 0;
+            Overflow.clear();
+        };
+
+        void
+        add(const T_VALUE& value, const T_COUNT count)
+        {
+            const key_type k = key(value);
+            if (cover(k, k)) {
+                Counts[k - _lo] += count;
+                mark(k - _lo);
+            } else {
+                Overflow[value] += count;
+            }
+        };
+
+        void    touch(const T_VALUE& value)
+        { add(value, static_cast<T_COUNT>(0)); };
+
+        void
+        touch_range(const T_VALUE& min, const T_VALUE& max)
+        {
+            if (max < min) return;
+            if (cover(key(min), key(max))) {
+                for (size_t i = key(min) - _lo; i <= key(max) - _lo; ++i) mark(i);
+            } else {
+                for (T_VALUE value = min; value <= max; ++value) touch(value);
+            }
+        };
+
+        //! Count each of values [first, first + n)
+        void
+        count(const T_VALUE* first, const size_t n)
+        {
+            if (n == 0) return;
+            T_VALUE min = first[0], max = first[0];
+            for (size_t i = 1; i < n; ++i) {
+                if (first[i] < min) min = first[i];
+                if (first[i] > max) max = first[i];
+            }
+            const size_t span = key(max) - key(min) + 1;
+            // a wide range of few values is cheaper counted one at a time
+            if (span <= n && cover(key(min), key(max))) {
+                count_window(first, n, key(min) - _lo, span);
+            } else {
+                for (size_t i = 0; i < n; ++i) add(first[i], static_cast<T_COUNT>(1));
+            }
+        };
+
+        void
+        merge(const HistogramCounts& o)
+        {
+            if (! o.Counts.empty()) {
+                for (size_t i = 0; i < o.Counts.size(); ++i) {
+                    if (o.Present[i]) add(value(o._lo + i), o.Counts[i]);
+                }
+            }
+            for (HistCI p = o.Overflow.begin(); p != o.Overflow.end(); ++p)
+                add(p->first, p->second);
+        };
+
+        //! Call f(value, count) for each present value, in order
+        template<class F>
+        void
+        for_each(F& f) const
+        {
+            HistCI p = Overflow.begin();
+            for ( ; p != Overflow.end() && key(p->first) < _lo; ++p)
+                f(p->first, p->second);
+            for (size_t i = 0; i < Counts.size(); ++i) {
+                if (Present[i]) f(value(_lo + i), Counts[i]);
+            }
+            for ( ; p != Overflow.end(); ++p) f(p->first, p->second);
+        };
+};
+
 /*! @class Histogram
     @brief Template to create a histogram of counts of unique values in a vector.
+
+    Counts are kept by HistogramCounts, in an array for integral value
+    types and in a std::map otherwise.  Histograms filled separately, for
+    example from parts of one vector on different threads, can be combined
+    with merge(); fill() does this itself when given more than one thread.
  */
 template<class T_VALUE, class T_COUNT>
 class Histogram {
     private:
-        std::map<T_VALUE, T_COUNT> Hist;
-        typedef typename std::map<T_VALUE, T_COUNT>::const_iterator HistCI;
+        typedef HistogramCounts<T_VALUE, T_COUNT> counts_type;
+        counts_type Hist;
         std::string value_name;
         std::string count_name;
         std::string freq_name;
 
+        // least values per thread worth starting a thread for
+        static const size_t min_per_thread = size_t(1) << 16;
+
+        struct SumCounts {
+            T_COUNT sum;
+            SumCounts() : sum(static_cast<T_COUNT>(0)) { };
+            void operator()(const T_VALUE&, const T_COUNT& c) { sum += c; };
+        };
+        struct PrintRows {
+            std::ostream& os;
+            const std::string& prefix;
+            const T_COUNT count_sum;
+            PrintRows(std::ostream& o, const std::string& p, const T_COUNT s)
+                : os(o), prefix(p), count_sum(s) { };
+            void operator()(const T_VALUE& v, const T_COUNT& c)
+            {
+                os << prefix;
+                os << v;
+                os << "\t" << c;
+                os << "\t" << std::setprecision(4)
+                    << ((double)c)/((double)count_sum);
+                os << std::endl;
+            };
+        };
+        struct CollectValues {
+            std::vector<T_VALUE> ans;
+            void operator()(const T_VALUE& v, const T_COUNT&) { ans.push_back(v); };
+        };
+        struct CollectCounts {
+            std::vector<T_COUNT> ans;
+            void operator()(const T_VALUE&, const T_COUNT& c) { ans.push_back(c); };
+        };
+
+        // count the values of a view, gathering those of an indexed view
+        // into a buffer a block at a time
+        static void
+        count_part(counts_type* part, const VectorView<T_VALUE> V)
+        {
+            if (V.contiguous()) {
+                if (! V.empty()) part->count(V.data(), V.size());
+                return;
+            }
+            const size_t block = 4096;
+            std::vector<T_VALUE> buf(VectorUtility::Min(block, V.size()));
+            for (size_t first = 0; first < V.size(); first += block) {
+                const size_t n = VectorUtility::Min(block, V.size() - first);
+                for (size_t i = 0; i < n; ++i) buf[i] = V[first + i];
+                part->count(&buf[0], n);
+            }
+        };
+
     public:
         /*! Constructor
 
-            @param Vec        vector of values, type used for template
+            @param Vec        vector, or VectorView, of values, type used
+                              for template
             @param drop_zero  bool, whether to drop zero-valued values (true)
             @param min_val    minimum_value of histogram range
             @param max_val    maximum_value of histogram range
             @param use_min    bool, whether to use the minimum value (false)
             @param use_max    bool, whether to use the maximum value (false)
          */
+        Histogram(const VectorView<T_VALUE>& Vec,
+                  bool drop_zero = true,
+                  T_VALUE min_val = T_VALUE(),
+                  T_VALUE max_val = T_VALUE(),
+                  bool use_min = false,
+                  bool use_max = false) 
+        {
+            if (Vec.size() == 0) {
+                std::cerr << "Histogram<T_VALUE,T_COUNT> : no values" 
+                    << std::endl;
+                exit(1);
+            }
+            names();
+            fill(Vec, drop_zero, min_val, max_val, use_min, use_max);
+        };
+
         Histogram(const std::vector<T_VALUE>& Vec,
                   bool drop_zero = true,
                   T_VALUE min_val = T_VALUE(),
@@ -47,6 +402,23 @@ class Histogram {
             fill(Vec, drop_zero, min_val, max_val, use_min, use_max);
         };
 
+        //! Constructor for an empty histogram, to be filled with add()
+        Histogram() { names(); };
+
+        /*! Add count occurrences of value
+
+            @param value      value to add
+            @param count      number of occurrences of value (1)
+         */
+        void add(const T_VALUE& value, T_COUNT count = static_cast<T_COUNT>(1))
+        { Hist.add(value, count); };
+
+        /*! Add the counts of another histogram, leaving names unchanged
+
+            @param h          histogram to add
+         */
+        void merge(const Histogram& h) { Hist.merge(h.Hist); };
+
         /*! Create names for value, counts, and frequencies.
 
             @param nv  string, name of value
@@ -58,7 +430,7 @@ class Histogram {
         { value_name = nv; count_name = nc; freq_name = nf; };
 
         //! Return histogram size
-        size_t size() { return(Hist.size()); }
+        size_t size() const { return(Hist.size()); }
 
         /*! Fill the histogram, workhorse method
 
@@ -66,19 +438,24 @@ class Histogram {
             max from Vec unless use_min or use_max are true, respectively, then
             use the parameter value.
 
-            @param Vec        vector of values, type used for template
+            @param Vec        vector, or VectorView, of values, type used
+                              for template
             @param drop_zero  bool, whether to drop zero-valued values (true)
             @param min_val    minimum_value of histogram range
             @param max_val    maximum_value of histogram range
             @param use_min    bool, whether to use the minimum value (false)
             @param use_max    bool, whether to use the maximum value (false)
+            @param nt         number of threads to count with (1), 0 for
+                              the number of hardware threads; each counts
+                              part of Vec and the parts are merged
          */
-        void fill(const std::vector<T_VALUE>& Vec,
+        void fill(const VectorView<T_VALUE>& Vec,
                   bool drop_zero = true,
                   T_VALUE min_value = T_VALUE(),
                   T_VALUE max_value = T_VALUE(),
                   bool use_min = false,
-                  bool use_max = false) 
+                  bool use_max = false,
+                  unsigned nt = 1) 
         {
             if (! drop_zero) {
                 // initialize all values in range to (T_COUNT)0
@@ -89,11 +466,35 @@ class Histogram {
                 else { min = VectorUtility::Min(Vec); }
                 if (max_value != T_VALUE() || use_max) { max = max_value; }
                 else {max = VectorUtility::Max(Vec); }
-                for (T_VALUE value = min; value <= max; ++value) {
-                    Hist[value] = static_cast<T_COUNT>(0);
-                }
+                Hist.touch_range(min, max);
+            }
+            if (Vec.empty()) return;
+            if (nt == 0) nt = std::thread::hardware_concurrency();
+            if (nt == 0) nt = 1;
+            if (nt > Vec.size() / min_per_thread) nt = Vec.size() / min_per_thread;
+            if (nt <= 1) { count_part(&Hist, Vec); return; }
+            std::vector<counts_type> Parts(nt);
+            std::vector<std::thread> threads;
+            for (unsigned t = 1; t < nt; ++t) {
+                size_t first = Vec.size() * t / nt, last = Vec.size() * (t + 1) / nt;
+                threads.push_back(std::thread(&Histogram::count_part, &Parts[t],
+                                              Vec.sub(first, last - first)));
             }
-            for (size_t i = 0; i < Vec.size(); ++i) { Hist[Vec[i]]++; }
+            count_part(&Parts[0], Vec.sub(0, Vec.size() / nt));
+            for (size_t t = 0; t < threads.size(); ++t) threads[t].join();
+            for (unsigned t = 0; t < nt; ++t) Hist.merge(Parts[t]);
+        };
+
+        void fill(const std::vector<T_VALUE>& Vec,
+                  bool drop_zero = true,
+                  T_VALUE min_value = T_VALUE(),
+                  T_VALUE max_value = T_VALUE(),
+                  bool use_min = false,
+                  bool use_max = false,
+                  unsigned nt = 1) 
+        {
+            fill(VectorView<T_VALUE>(Vec), drop_zero, min_value, max_value,
+                 use_min, use_max, nt);
         };
 
         //! Simple print method
@@ -113,38 +514,26 @@ class Histogram {
                 os << "\t" << freq_name;
                 os << std::endl;
             }
-            T_COUNT count_sum = static_cast<T_COUNT>(0);
-            for (HistCI p = Hist.begin(); p != Hist.end(); ++p) {
-                count_sum += p->second; 
-            }
-            for (HistCI p = Hist.begin(); p != Hist.end(); ++p) {
-                os << prefix;
-                os << p->first;
-                os << "\t" << p->second;
-                os << "\t" << std::setprecision(4) 
-                    << ((double)p->second)/((double)count_sum);
-                os << std::endl;
-            }
+            SumCounts s;
+            Hist.for_each(s);
+            PrintRows rows(os, prefix, s.sum);
+            Hist.for_each(rows);
         };
 
         //! Return a vector of observed values
         const std::vector<T_VALUE> values() const
         {
-            std::vector<T_VALUE> ans;
-            for (HistCI p = Hist.begin(); p != Hist.end(); ++p) {
-                ans.push_back(p->first); 
-            }
-            return(ans);
+            CollectValues c;
+            Hist.for_each(c);
+            return(c.ans);
         };
 
         //! Return a vector of observed counts
         const std::vector<T_COUNT> counts() const
         {
-            std::vector<T_COUNT> ans;
-            for (HistCI p = Hist.begin(); p != Hist.end(); ++p) {
-                ans.push_back(p->second); 
-            }
-            return(ans);
+            CollectCounts c;
+            Hist.for_each(c);
+            return(c.ans);
         };
 
         //! Suitable for inclusion in an ostream oparation
@@ -158,4 +547,3 @@ class Histogram {
 };
 
 #endif // __HISTOGRAM_H__
-
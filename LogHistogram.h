@@ -0,0 +1,158 @@
+#ifndef LOGHISTOGRAM_H
+#define LOGHISTOGRAM_H
+
+#include <vector>
+#include <string>
+#include <cstddef>
+#include <cstdlib>
+#include <cassert>
+#include <iostream>
+#include <iomanip>
+
+/*! @class LogHistogram
+
+    @brief Histogram of non-negative integral values in logarithmic bins.
+
+    Run lengths on a long chromosome span many orders of magnitude, and a
+    Histogram of them has a row for every distinct length.  Here each power
+    of two [2^e, 2^(e+1)) is split into 2^sub_bits bins of equal width, so
+    the relative width of a bin is at most 2^-sub_bits whatever the value,
+    and values below 2^sub_bits each get a bin of their own.  The bin of a
+    value is found from the position of its highest bit, without a search,
+    and bins are kept in an array, so counting costs O(1) per value and the
+    histogram has at most 64 * 2^sub_bits bins.
+
+    Histograms with the same sub_bits can be combined with merge().
+    print_table() prints one row per non-empty bin, with the first and last
+    values of the bin.
+ */
+template<class T_VALUE, class T_COUNT>
+class LogHistogram {
+
+    private:
+
+        unsigned                _sub_bits;
+        std::vector<T_COUNT>    Counts;
+        std::string             value_name;
+        std::string             count_name;
+        std::string             freq_name;
+
+        static unsigned
+        high_bit(const unsigned long long v)
+        { return(63 - __builtin_clzll(v)); };
+
+    public:
+
+        /*! Constructor
+
+            @param sub_bits   bins per power of two are 2^sub_bits (3)
+         */
+        LogHistogram(const unsigned sub_bits = 3)
+            : _sub_bits(sub_bits)
+        {
+            assert(sub_bits < 16);
+            names();
+        };
+
+        void names(const std::string& nv = "", const std::string& nc = "",
+                   const std::string& nf = "")
+        { value_name = nv; count_name = nc; freq_name = nf; };
+
+        unsigned    sub_bits() const    { return(_sub_bits); };
+        size_t      num_bins() const    { return(Counts.size()); };
+        T_COUNT     count(const size_t b) const  { return(Counts[b]); };
+
+        //! Bin holding value v
+        size_t
+        bin(const T_VALUE v) const
+        {
+            assert(v >= 0);
+            const unsigned long long u = v;
+            const size_t sub = size_t(1) << _sub_bits;
+            if (u < sub) return(u);
+            const unsigned e = high_bit(u);
+            return(sub * (e - _sub_bits + 1) + ((u >> (e - _sub_bits)) - sub));
+        };
+
+        //! First value of bin b
+        T_VALUE
+        bin_start(const size_t b) const
+        {
+            const size_t sub = size_t(1) << _sub_bits;
+            if (b < sub) return(static_cast<T_VALUE>(b));
+            const unsigned e = b / sub + _sub_bits - 1;
+            return(static_cast<T_VALUE>((b % sub + sub) << (e - _sub_bits)));
+        };
+
+        //! Last value of bin b
+        T_VALUE
+        bin_end(const size_t b) const
+        {
+            const size_t sub = size_t(1) << _sub_bits;
+            if (b < sub) return(static_cast<T_VALUE>(b));
+            const unsigned e = b / sub + _sub_bits - 1;
+            return(static_cast<T_VALUE>(bin_start(b) + ((1ULL << (e - _sub_bits)) - 1)));
+        };
+
+        /*! Add count occurrences of value
+
+            @param value      value to add, >= 0
+            @param count      number of occurrences of value (1)
+         */
+        void
+        add(const T_VALUE& value, T_COUNT count = static_cast<T_COUNT>(1))
+        {
+            const size_t b = bin(value);
+            if (b >= Counts.size()) Counts.resize(b + 1, static_cast<T_COUNT>(0));
+            Counts[b] += count;
+        };
+
+        //! Add one occurrence of each value in Vec
+        void
+        fill(const std::vector<T_VALUE>& Vec)
+        { for (size_t i = 0; i < Vec.size(); ++i) add(Vec[i]); };
+
+        //! Add the counts of another histogram with the same sub_bits
+        void
+        merge(const LogHistogram& h)
+        {
+            if (h._sub_bits != _sub_bits) {
+                std::cerr << "LogHistogram::merge : histograms have different sub_bits"
+                    << std::endl;
+                exit(1);
+            }
+            if (h.Counts.size() > Counts.size())
+                Counts.resize(h.Counts.size(), static_cast<T_COUNT>(0));
+            for (size_t b = 0; b < h.Counts.size(); ++b) Counts[b] += h.Counts[b];
+        };
+
+        //! Print non-empty bins as a table
+        void
+        print_table(std::ostream& os = std::cout,
+                    const bool header = true,
+                    const std::string& prefix = "") const
+        {
+            if (header) {
+                os << prefix;
+                os << value_name << "_start";
+                os << "\t" << value_name << "_end";
+                os << "\t" << count_name;
+                os << "\t" << freq_name;
+                os << std::endl;
+            }
+            T_COUNT count_sum = static_cast<T_COUNT>(0);
+            for (size_t b = 0; b < Counts.size(); ++b) count_sum += Counts[b];
+            for (size_t b = 0; b < Counts.size(); ++b) {
+                if (Counts[b] == static_cast<T_COUNT>(0)) continue;
+                os << prefix;
+                os << bin_start(b);
+                os << "\t" << bin_end(b);
+                os << "\t" << Counts[b];
+                os << "\t" << std::setprecision(4)
+                    << ((double)Counts[b])/((double)count_sum);
+                os << std::endl;
+            }
+        };
+};
+
+#endif // LOGHISTOGRAM_H
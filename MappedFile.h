@@ -0,0 +1,148 @@
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <string>
+#include <algorithm>
+#include <iostream>
+#include <cstddef>
+#include <cstring>
+#include <cerrno>
+#include <sys/types.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+/*! @class MappedFile
+
+    @brief A file mapped shared into memory, read-write.
+
+    Changes made through the mapping are written back to the file by the
+    kernel in its own time, or at once by sync(); the file stays on disk
+    after close().  advise() passes access-pattern hints for the mapping, or
+    for a part of it, on to the kernel with madvise(); ranges are widened to
+    whole pages.  Errors are reported to std::cerr and the mapping is left
+    closed.
+ */
+class MappedFile {
+
+    public:
+
+        enum advice_type { ADVISE_NORMAL = MADV_NORMAL,
+                           ADVISE_SEQUENTIAL = MADV_SEQUENTIAL,
+                           ADVISE_RANDOM = MADV_RANDOM,
+                           ADVISE_WILLNEED = MADV_WILLNEED,
+                           ADVISE_DONTNEED = MADV_DONTNEED };
+
+    private:
+
+        std::string     _filename;
+        int             _fd;
+        char*           _addr;
+        size_t          _length;
+
+        MappedFile(const MappedFile&);             // not copyable, owns a mapping
+        MappedFile& operator=(const MappedFile&);
+
+        bool
+        fail(const char* what)
+        {
+            std::cerr << "MappedFile : " << what << " " << _filename << " : "
+                << strerror(errno) << std::endl;
+            close();
+            return(false);
+        };
+
+    public:
+
+        MappedFile() : _fd(-1), _addr(0), _length(0) { };
+        ~MappedFile() { close(); };
+
+        static size_t   page_size() { return(sysconf(_SC_PAGESIZE)); };
+
+        /*! Map a file
+
+            @param filename  file to map
+            @param length    bytes to map; 0 to map the existing file whole,
+                             otherwise the file is extended or truncated to
+                             length, and created if need be
+         */
+        bool
+        open(const std::string& filename, const size_t length = 0)
+        {
+            close();
+            _filename = filename;
+            int flags = O_RDWR | (length ? O_CREAT : 0);
+            if ((_fd = ::open(filename.c_str(), flags, 0644)) < 0)
+                return(fail("cannot open"));
+            if (length) {
+                if (ftruncate(_fd, length) != 0) return(fail("cannot size"));
+                _length = length;
+            } else {
+                struct stat st;
+                if (fstat(_fd, &st) != 0) return(fail("cannot stat"));
+                _length = st.st_size;
+            }
+            if (_length == 0) {
+                errno = EINVAL;
+                return(fail("cannot map empty file"));
+            }
+            void* a = mmap(0, _length, PROT_READ | PROT_WRITE, MAP_SHARED, _fd, 0);
+            if (a == MAP_FAILED) return(fail("cannot map"));
+            _addr = static_cast<char*>(a);
+            return(true);
+        };
+
+        void
+        close()
+        {
+            if (_addr) munmap(_addr, _length);
+            if (_fd >= 0) ::close(_fd);
+            _addr = 0;
+            _fd = -1;
+            _length = 0;
+        };
+
+        void
+        swap(MappedFile& m)
+        {
+            std::swap(_filename, m._filename);
+            std::swap(_fd, m._fd);
+            std::swap(_addr, m._addr);
+            std::swap(_length, m._length);
+        };
+
+        bool                is_open() const       { return(_addr != 0); };
+        const std::string&  get_filename() const  { return(_filename); };
+        size_t              size() const          { return(_length); };
+        char*               data()                { return(_addr); };
+        const char*         data() const          { return(_addr); };
+
+        //! Write changes back to the file now
+        bool
+        sync()
+        {
+            if (! _addr) return(false);
+            if (msync(_addr, _length, MS_SYNC) != 0) {
+                std::cerr << "MappedFile : cannot sync " << _filename << " : "
+                    << strerror(errno) << std::endl;
+                return(false);
+            }
+            return(true);
+        };
+
+        //! Hint how bytes [offset, offset + length) will be used, by
+        //! default the whole mapping
+        void
+        advise(const advice_type a, size_t offset = 0, size_t length = 0) const
+        {
+            if (! _addr || offset >= _length) return;
+            if (length == 0 || length > _length - offset) length = _length - offset;
+            const size_t page = page_size();
+            size_t start = offset / page * page;
+            madvise(_addr + start, length + (offset - start), int(a));
+        };
+};
+
+#endif // MAPPEDFILE_H
+
@@ -1,6 +1,6 @@
 #ifndef BINOM_H
 #define BINOM_H
-#include "RandUniform.h"
+#include "RandUniformPool.h"
 
 #include <iostream>
 #include <cassert>
@@ -31,7 +31,7 @@ class RandBinomial {
     public:
         RandBinomial();
     private:
-        RandUniform uniform;
+        RandUniformPool uniform;
         double psave;
         long nsave;
         long ignbin, i, ix, ix1, k, m, mp, T1;
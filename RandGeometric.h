@@ -34,11 +34,11 @@
 #include <cmath>
 #include <ctime>
 #include <cassert>
-#include "RandUniform.h"
+#include "RandUniformPool.h"
 
 class RandGeometric {
     private:
-        RandUniform    unif;
+        RandUniformPool unif;
         double         prob;  // the probability until the first success
         double         log_1_minus_prob;  // log(1.0 - prob)
         bool           seed_set;
@@ -60,6 +60,13 @@ class RandGeometric {
             seed_set = true;
         };
 
+        // seed from a numbered stream, see RandUniform::init_stream()
+        void           init_stream(const unsigned long stream)
+        {
+            unif.init_stream(stream);
+            seed_set = true;
+        };
+
         long           draw()
         {
             assert(seed_set == true);
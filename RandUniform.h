@@ -1,10 +1,25 @@
 #ifndef RANDUNIFORM_H
 #define RANDUNIFORM_H
 
+// Marsaglia's universal uniform random number generator.  Other generators
+// providing class RandUniform with the same interface can be selected in its
+// place by defining one of the following when compiling:
+//
+//   RANDUNIFORM_PHILOX   counter-based Philox4x32-10, RandUniform_Philox.h
+//   RANDUNIFORM_GSL      Knuth's subtractive ran3(), RandUniform_GSL.h
+
+#if defined(RANDUNIFORM_PHILOX)
+#include "RandUniform_Philox.h"
+#elif defined(RANDUNIFORM_GSL)
+#include "RandUniform_GSL.h"
+#else
+
+#include "Checkpoint.h"
 #include <iostream>
 #include <cassert>
 #include <cmath>
 #include <ctime>
+#include <cstddef>
 
 class RandUniform {
     public:
@@ -16,9 +31,20 @@ class RandUniform {
         double u[98], c, cd, cm;
         int i97, j97;
     public:
+        // Seeds are pairs 0 <= ij <= 31328, 0 <= kl <= 30081, each pair
+        // giving a different sequence.  init_stream() numbers the pairs so
+        // that streams 0 .. num_streams - 1 are all distinct.
+        static const unsigned long num_streams = 31329UL * 30082UL;
+
         void   init(const bool random_seed = false,
                     const int ij = 1802, const int kl = 9373);
+        void   init_stream(const unsigned long stream);
         double draw();
+        void   draw_n(double* out, const size_t n);
+
+        // generator state, for checkpoints
+        void   save_state(std::ostream& os) const;
+        bool   load_state(std::istream& is);
 };
 
 inline void RandUniform::init(const bool random_seed, const int ij,
@@ -65,6 +91,17 @@ inline void RandUniform::init(const bool random_seed, const int ij,
     test = true;
 }
 
+inline void RandUniform::init_stream(const unsigned long stream)
+{
+    if (stream >= num_streams) {
+        std::cerr << "RandUniform::init_stream: stream must be less than "
+            << num_streams << std::endl;
+    }
+    assert(stream < num_streams);
+    init(false, static_cast<int>(stream % 31329),
+         static_cast<int>(stream / 31329));
+}
+
 inline double RandUniform::draw()
 {
     double uni;
@@ -87,5 +124,53 @@ inline double RandUniform::draw()
 	return uni;
 }
 
+// Fill out[0 .. n-1] with the next n draws.  The sequence is the same as
+// n calls to draw(), but the generator state is kept in locals across the
+// loop and the init() check is made once.
+inline void RandUniform::draw_n(double* out, const size_t n)
+{
+    if (test == false) {
+        std::cerr << "RandUniform::draw_n: Call init() first." << std::endl;
+    }
+    assert(test == true);
+    int i = i97, j = j97;
+    double cc = c;
+    for (size_t k = 0; k < n; ++k) {
+        double uni = u[i] - u[j];
+        if (uni < 0.0) uni += 1.0;
+        u[i] = uni;
+        if (--i == 0) i = 97;
+        if (--j == 0) j = 97;
+        cc -= cd;
+        if (cc < 0.0) cc += cm;
+        uni -= cc;
+        if (uni < 0.0) uni += 1.0;
+        out[k] = uni;
+    }
+    i97 = i; j97 = j;
+    c = cc;
+}
+
+inline void RandUniform::save_state(std::ostream& os) const
+{
+    Checkpoint::write(os, test);
+    Checkpoint::write_array(os, u, 98);
+    Checkpoint::write(os, c);
+    Checkpoint::write(os, cd);
+    Checkpoint::write(os, cm);
+    Checkpoint::write(os, i97);
+    Checkpoint::write(os, j97);
+}
+
+inline bool RandUniform::load_state(std::istream& is)
+{
+    return(Checkpoint::read(is, test) && Checkpoint::read_array(is, u, 98) &&
+           Checkpoint::read(is, c) && Checkpoint::read(is, cd) &&
+           Checkpoint::read(is, cm) && Checkpoint::read(is, i97) &&
+           Checkpoint::read(is, j97));
+}
+
+#endif // RANDUNIFORM_PHILOX, RANDUNIFORM_GSL
+
 #endif // RANDUNIFORM_H
 
@@ -0,0 +1,81 @@
+#ifndef RANDUNIFORMPOOL_H
+#define RANDUNIFORMPOOL_H
+
+#include <vector>
+#include <cstddef>
+#include "RandUniform.h"
+#include "Checkpoint.h"
+
+/*! @class RandUniformPool
+
+    @brief A RandUniform that hands out draws from a pre-generated block.
+
+    The block is refilled with RandUniform::draw_n(), so most calls to draw()
+    are an index check and a load.  The draws are exactly those RandUniform
+    would give one at a time, in the same order, so a pool can replace a
+    RandUniform without changing results.  Consumers that want many draws at
+    once can take them with draw_n().
+ */
+class RandUniformPool {
+
+    private:
+
+        RandUniform            unif;
+        std::vector<double>    Pool;
+        size_t                 next;  // next unused draw in Pool
+
+        void refill() { unif.draw_n(&Pool[0], Pool.size()); next = 0; };
+
+    public:
+
+        /*! constructor
+
+            @param random_seed  passed to RandUniform::init()
+            @param n            number of draws generated at a time
+         */
+        RandUniformPool(bool random_seed = false, size_t n = 256) 
+            : unif(random_seed), Pool(n), next(n)
+        { /* empty */ };
+
+        // (re)seeding discards any draws remaining in the pool
+        void   init(const bool random_seed = false)
+        { unif.init(random_seed); next = Pool.size(); };
+        void   init_stream(const unsigned long stream)
+        { unif.init_stream(stream); next = Pool.size(); };
+
+        double draw()
+        {
+            if (next == Pool.size()) refill();
+            return(Pool[next++]);
+        };
+
+        //! Fill out[0 .. n-1] with the next n draws
+        void   draw_n(double* out, size_t n)
+        {
+            while (n > 0 && next < Pool.size()) { *out++ = Pool[next++]; --n; }
+            if (n >= Pool.size()) { unif.draw_n(out, n); return; }
+            if (n > 0) {
+                refill();
+                for (size_t k = 0; k < n; ++k) out[k] = Pool[next++];
+            }
+        };
+
+        // generator state and unused draws, for checkpoints
+        void   save_state(std::ostream& os) const
+        {
+            unif.save_state(os);
+            Checkpoint::write_vector(os, Pool);
+            Checkpoint::write(os, static_cast<unsigned long>(next));
+        };
+
+        bool   load_state(std::istream& is)
+        {
+            unsigned long n;
+            if (! unif.load_state(is) || ! Checkpoint::read_vector(is, Pool) ||
+                ! Checkpoint::read(is, n)) return(false);
+            next = n;
+            return(next <= Pool.size());
+        };
+};
+
+#endif // RANDUNIFORMPOOL_H
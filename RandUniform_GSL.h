@@ -29,6 +29,8 @@
 #include <cmath>
 #include <ctime>
 #include <cassert>
+#include <cstddef>
+#include "Checkpoint.h"
 
 class RandUniform {
     public:
@@ -72,6 +74,31 @@ class RandUniform {
         // return random double
         void    init(int seed = 1);
         double  draw();
+        void    draw_n(double* out, const size_t n)
+        {
+            assert(seed_set == true);
+            for (size_t k = 0; k < n; ++k) out[k] = ran3_get_double();
+        }
+
+        // generator state, for checkpoints
+        void    save_state(std::ostream& os) const
+        {
+            Checkpoint::write(os, seed_set);
+            Checkpoint::write(os, state);
+        }
+        bool    load_state(std::istream& is)
+        {
+            return(Checkpoint::read(is, seed_set) && Checkpoint::read(is, state));
+        }
+
+        // seeds 1 .. num_streams each give a different sequence, and
+        // init_stream() numbers them from 0 
+        static const unsigned long num_streams = 161803397UL;
+        void    init_stream(const unsigned long stream)
+        {
+            assert(stream < num_streams);
+            ran3_set(stream + 1);
+        }
 };
 
 inline unsigned long int RandUniform::ran3_get () {
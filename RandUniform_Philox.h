@@ -0,0 +1,212 @@
+#ifndef __RANDUNIFORM_PHILOX_H__
+#define __RANDUNIFORM_PHILOX_H__
+
+// Counter-based uniform random number generator, Philox4x32-10 from
+// Salmon, Moraes, Dror and Shaw 2011 Parallel random numbers: as easy as
+// 1, 2, 3.  Proceedings of the International Conference for High
+// Performance Computing, Networking, Storage and Analysis (SC11).
+//
+// The generator is a keyed bijection of a 128-bit counter, so its state is
+// just the key, the counter and the current output block.  We use the key
+// for the seed, the high 64 bits of the counter for a stream number and the
+// low 64 bits for the block within the stream.  Each block gives two draws.
+// Streams therefore never overlap (each holds 2^64 draws), and any number
+// of draws can be skipped in O(1) with jump().
+//
+// This provides class RandUniform with the same init()/draw() interface as
+// RandUniform.h, and is selected in its place by defining RANDUNIFORM_PHILOX
+// when compiling.
+
+#include <iostream>
+#include <cassert>
+#include <ctime>
+#include <cstddef>
+#include <stdint.h>
+#include "Checkpoint.h"
+
+class RandUniform {
+    public:
+        RandUniform(bool random_seed = false) : test(false) {
+            init(random_seed);
+        };
+    private:
+        bool     test;
+        uint32_t key[2];
+        uint64_t stream;    // high 64 bits of the counter
+        uint64_t pos;       // index of the next draw within the stream
+        uint64_t block;     // block held in out[]
+        uint32_t out[4];    // output for block, two draws
+        bool     out_valid;
+
+        static void philox(const uint32_t k[2], const uint32_t c[4],
+                           uint32_t o[4]);
+        void        fill_block(uint64_t b);
+    public:
+        // every stream is distinct and non-overlapping, see init_stream()
+        static const unsigned long num_streams = ~0UL;
+
+        void   init(const bool random_seed = false,
+                    const int ij = 1802, const int kl = 9373);
+        void   init_stream(const unsigned long strm);
+        void   init_key(const uint64_t seed, const uint64_t strm);
+        void   jump(const uint64_t n);
+        double draw();
+        void   draw_n(double* out, const size_t n);
+
+        // generator state, for checkpoints
+        void   save_state(std::ostream& os) const;
+        bool   load_state(std::istream& is);
+};
+
+inline void RandUniform::philox(const uint32_t k[2], const uint32_t c[4],
+                                uint32_t o[4])
+{
+    const uint32_t M0 = 0xD2511F53, M1 = 0xCD9E8D57;
+    const uint32_t W0 = 0x9E3779B9, W1 = 0xBB67AE85;
+    uint32_t k0 = k[0], k1 = k[1];
+    uint32_t c0 = c[0], c1 = c[1], c2 = c[2], c3 = c[3];
+    for (int round = 0; round < 10; ++round) {
+        uint64_t p0 = uint64_t(M0) * c0;
+        uint64_t p1 = uint64_t(M1) * c2;
+        uint32_t hi0 = uint32_t(p0 >> 32), lo0 = uint32_t(p0);
+        uint32_t hi1 = uint32_t(p1 >> 32), lo1 = uint32_t(p1);
+        c0 = hi1 ^ c1 ^ k0;
+        c1 = lo1;
+        c2 = hi0 ^ c3 ^ k1;
+        c3 = lo0;
+        k0 += W0;
+        k1 += W1;
+    }
+    o[0] = c0; o[1] = c1; o[2] = c2; o[3] = c3;
+}
+
+// compute the output for block b of the current stream
+inline void RandUniform::fill_block(uint64_t b)
+{
+    uint32_t c[4] = { uint32_t(b), uint32_t(b >> 32),
+                      uint32_t(stream), uint32_t(stream >> 32) };
+    philox(key, c, out);
+    block = b;
+    out_valid = true;
+}
+
+// For compatibility with RandUniform.h, the (ij, kl) seed pair is used as
+// the key of stream 0.  The ranges of ij and kl are not restricted.
+inline void RandUniform::init(const bool random_seed, const int ij,
+    const int kl)
+{
+    uint32_t iij = static_cast<uint32_t>(ij);
+    if (random_seed == true) {
+        iij = static_cast<uint32_t>(time(NULL));  // system clock seed
+    }
+    init_key((uint64_t(iij) << 32) | static_cast<uint32_t>(kl), 0);
+}
+
+inline void RandUniform::init_stream(const unsigned long strm)
+{
+    init_key(0, strm);
+}
+
+/*! Seed with a 64-bit key and start at the beginning of a 64-bit stream
+ */
+inline void RandUniform::init_key(const uint64_t seed, const uint64_t strm)
+{
+    key[0] = uint32_t(seed);
+    key[1] = uint32_t(seed >> 32);
+    stream = strm;
+    pos = 0;
+    out_valid = false;
+    test = true;
+}
+
+/*! Skip the next n draws in O(1)
+ */
+inline void RandUniform::jump(const uint64_t n)
+{
+    pos += n;
+}
+
+inline double RandUniform::draw()
+{
+    if (test == false) {
+        std::cerr << "RandUniform::draw: Call init() first." << std::endl;
+    }
+    assert(test == true);
+    if (! out_valid || block != (pos >> 1)) fill_block(pos >> 1);
+    // 53 random bits from two 32-bit words
+    const uint32_t* o = out + 2 * (pos & 1);
+    ++pos;
+    return(((o[0] >> 5) * 67108864.0 + (o[1] >> 6)) * (1.0 / 9007199254740992.0));
+}
+
+// Fill out[0 .. n-1] with the next n draws, the same sequence as n calls to
+// draw().  Blocks are independent of one another, so whole blocks are
+// computed lane-wise, batch_blocks at a time, in loops without dependencies
+// between lanes that the compiler can vectorize.
+inline void RandUniform::draw_n(double* out, const size_t n)
+{
+    if (test == false) {
+        std::cerr << "RandUniform::draw_n: Call init() first." << std::endl;
+    }
+    assert(test == true);
+    const double scale = 1.0 / 9007199254740992.0;
+    size_t k = 0;
+    // finish a partly-used block
+    while (k < n && (pos & 1)) out[k++] = draw();
+
+    enum { batch_blocks = 8 };
+    const uint32_t M0 = 0xD2511F53, M1 = 0xCD9E8D57;
+    const uint32_t W0 = 0x9E3779B9, W1 = 0xBB67AE85;
+    const uint32_t s0 = uint32_t(stream), s1 = uint32_t(stream >> 32);
+    while (n - k >= 2 * batch_blocks) {
+        uint32_t c0[batch_blocks], c1[batch_blocks], c2[batch_blocks], 
+                 c3[batch_blocks];
+        uint64_t b = pos >> 1;
+        for (int l = 0; l < batch_blocks; ++l) {
+            c0[l] = uint32_t(b + l);
+            c1[l] = uint32_t((b + l) >> 32);
+            c2[l] = s0;
+            c3[l] = s1;
+        }
+        uint32_t k0 = key[0], k1 = key[1];
+        for (int round = 0; round < 10; ++round) {
+            for (int l = 0; l < batch_blocks; ++l) {
+                uint64_t p0 = uint64_t(M0) * c0[l];
+                uint64_t p1 = uint64_t(M1) * c2[l];
+                uint32_t n0 = uint32_t(p1 >> 32) ^ c1[l] ^ k0;
+                uint32_t n2 = uint32_t(p0 >> 32) ^ c3[l] ^ k1;
+                c1[l] = uint32_t(p1);
+                c3[l] = uint32_t(p0);
+                c0[l] = n0;
+                c2[l] = n2;
+            }
+            k0 += W0;
+            k1 += W1;
+        }
+        for (int l = 0; l < batch_blocks; ++l) {
+            out[k + 2 * l]     = ((c0[l] >> 5) * 67108864.0 + (c1[l] >> 6)) * scale;
+            out[k + 2 * l + 1] = ((c2[l] >> 5) * 67108864.0 + (c3[l] >> 6)) * scale;
+        }
+        k += 2 * batch_blocks;
+        pos += 2 * batch_blocks;
+    }
+    while (k < n) out[k++] = draw();
+}
+
+inline void RandUniform::save_state(std::ostream& os) const
+{
+    // out[] is recomputed from the counter on the next draw
+    Checkpoint::write(os, test);
+    Checkpoint::write_array(os, key, 2);
+    Checkpoint::write(os, stream);
+    Checkpoint::write(os, pos);
+}
+
+inline bool RandUniform::load_state(std::istream& is)
+{
+    out_valid = false;
+    return(Checkpoint::read(is, test) && Checkpoint::read_array(is, key, 2) &&
+           Checkpoint::read(is, stream) && Checkpoint::read(is, pos));
+}
+
+#endif // __RANDUNIFORM_PHILOX_H__
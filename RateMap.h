@@ -0,0 +1,217 @@
+#ifndef RATEMAP_H
+#define RATEMAP_H
+
+#include <vector>
+#include <string>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include <cassert>
+#include "AliasTable.h"
+#include "Checkpoint.h"
+
+/*! @class RateMap
+
+    @brief Piecewise-constant relative rates along a sequence, with O(1)
+           sampling of sites in proportion to their rates.
+
+    The sequence of size() sites is divided into bins, bin i covering sites
+    [start(i), start(i + 1)), each with a relative rate per site.  Only
+    sites from first_site() on can be sampled, for breaks which cannot fall
+    before the first site.  An AliasTable over the bins, weighted by rate
+    times the number of sampleable sites in each, picks a bin in O(1)
+    whatever the number of bins, and a second draw picks a site uniformly
+    within it.  total() is the sum of the rates of sampleable sites, which
+    is the number of sampleable sites if every rate is 1.
+
+    Maps are read from BED-like files by load().
+ */
+class RateMap {
+
+    private:
+
+        size_t                  _size;
+        size_t                  _first;
+        std::vector<size_t>     Starts;
+        std::vector<double>     Rates;
+        AliasTable              Table;
+
+        size_t  end_of(size_t i) const
+        { return(i + 1 < Starts.size() ? Starts[i + 1] : _size); };
+        size_t  sampled_start(size_t i) const
+        { return(std::max(Starts[i], _first)); };
+
+    public:
+
+        RateMap() : _size(0), _first(0) { };
+
+        bool    empty() const       { return(Starts.empty()); };
+        size_t  size() const        { return(_size); };
+        size_t  first_site() const  { return(_first); };
+        size_t  num_bins() const    { return(Starts.size()); };
+        double  total() const       { return(Table.total()); };
+
+        void
+        clear()
+        {
+            _size = _first = 0;
+            Starts.clear();
+            Rates.clear();
+            Table = AliasTable();
+        };
+
+        /*! Set the bins and build the sampling table
+
+            @param n       number of sites
+            @param first   first site that can be sampled
+            @param starts  start of each bin, increasing from 0
+            @param rates   non-negative relative rate per site of each bin
+         */
+        void
+        assign(const size_t n, const size_t first,
+               const std::vector<size_t>& starts,
+               const std::vector<double>& rates)
+        {
+            assert(starts.size() == rates.size() && ! starts.empty());
+            assert(starts[0] == 0 && first < n);
+            _size = n;
+            _first = first;
+            Starts = starts;
+            Rates = rates;
+            std::vector<double> weights(Starts.size(), 0.0);
+            for (size_t i = 0; i < Starts.size(); ++i) {
+                size_t lo = sampled_start(i), hi = end_of(i);
+                if (hi > lo) weights[i] = Rates[i] * (hi - lo);
+            }
+            Table.build(weights);
+        };
+
+        //! Relative rate of site i
+        double
+        rate(const size_t i) const
+        {
+            assert(i < _size);
+            if (i < _first) return(0.0);
+            return(Rates[std::upper_bound(Starts.begin(), Starts.end(), i) -
+                         Starts.begin() - 1]);
+        };
+
+        /*! Sample a site
+
+            @param u_bin   uniform draw in [0, 1) choosing the bin
+            @param u_site  uniform draw in [0, 1) choosing the site within it
+         */
+        size_t
+        sample(const double u_bin, const double u_site) const
+        {
+            size_t i = Table.sample(u_bin);
+            size_t lo = sampled_start(i), hi = end_of(i);
+            size_t site = lo + static_cast<size_t>(u_site * (hi - lo));
+            return(site < hi ? site : hi - 1);
+        };
+
+        /*! Read a map for n sites from a BED-like file
+
+            Each line is 'chrom start end rate', with start and end 0-based
+            and end exclusive as in BED; chrom is ignored.  Blank lines,
+            lines beginning with '#' and 'track' and 'browser' lines are
+            skipped.  Intervals must not overlap and must lie within
+            [0, n); sites outside every interval get default_rate.
+
+            @param filename      file to read
+            @param n             number of sites
+            @param first         first site that can be sampled
+            @param default_rate  rate of sites outside every interval
+         */
+        void
+        load(const std::string& filename, const size_t n, const size_t first = 0,
+             const double default_rate = 1.0)
+        {
+            std::ifstream ifs(filename.c_str());
+            if (! ifs) {
+                std::cerr << "RateMap::load : cannot open " << filename << std::endl;
+                exit(1);
+            }
+            struct Interval {
+                size_t start, end; double rate;
+                bool operator<(const Interval& o) const { return(start < o.start); };
+            };
+            std::vector<Interval> intervals;
+            std::string line;
+            long line_num = 0;
+            while (std::getline(ifs, line)) {
+                ++line_num;
+                std::istringstream iss(line);
+                std::string chrom;
+                if (! (iss >> chrom) || chrom[0] == '#' || chrom == "track" ||
+                    chrom == "browser") continue;
+                long start, end;
+                double rate;
+                if (! (iss >> start >> end >> rate) || start < 0 || end <= start ||
+                    size_t(end) > n || rate < 0.0) {
+                    std::cerr << "RateMap::load : " << filename << " line "
+                        << line_num << " is not 'chrom start end rate' with "
+                        "0 <= start < end <= " << n << " and rate >= 0"
+                        << std::endl;
+                    exit(1);
+                }
+                Interval iv = { size_t(start), size_t(end), rate };
+                intervals.push_back(iv);
+            }
+            std::sort(intervals.begin(), intervals.end());
+            std::vector<size_t> starts;
+            std::vector<double> rates;
+            size_t pos = 0;
+            for (size_t i = 0; i < intervals.size(); ++i) {
+                const Interval& iv = intervals[i];
+                if (iv.start < pos) {
+                    std::cerr << "RateMap::load : " << filename
+                        << " has overlapping intervals at " << iv.start << std::endl;
+                    exit(1);
+                }
+                if (iv.start > pos) {
+                    starts.push_back(pos);
+                    rates.push_back(default_rate);
+                }
+                starts.push_back(iv.start);
+                rates.push_back(iv.rate);
+                pos = iv.end;
+            }
+            if (pos < n) {
+                starts.push_back(pos);
+                rates.push_back(default_rate);
+            }
+            assign(n, first, starts, rates);
+        };
+
+        // bins and table, for checkpoints
+        void
+        save_state(std::ostream& os) const
+        {
+            Checkpoint::write(os, static_cast<uint64_t>(_size));
+            Checkpoint::write(os, static_cast<uint64_t>(_first));
+            Checkpoint::write_vector(os, Starts);
+            Checkpoint::write_vector(os, Rates);
+            if (! empty()) Table.save_state(os);
+        };
+
+        bool
+        load_state(std::istream& is)
+        {
+            uint64_t n, first;
+            if (! (Checkpoint::read(is, n) && Checkpoint::read(is, first) &&
+                   Checkpoint::read_vector(is, Starts) &&
+                   Checkpoint::read_vector(is, Rates) &&
+                   Starts.size() == Rates.size())) return(false);
+            _size = n;
+            _first = first;
+            if (empty()) { Table = AliasTable(); return(true); }
+            return(Table.load_state(is));
+        };
+};
+
+#endif // RATEMAP_H
+
@@ -0,0 +1,100 @@
+#ifndef REPLICATES_H
+#define REPLICATES_H
+
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <functional>
+#include <cassert>
+#include <iostream>
+#include "Chromosome.h"
+
+/*! @class Replicates
+
+    @brief Run replicate Chromosome simulations across a pool of threads.
+
+    Replicate r is run on a freshly constructed Chromosome seeded with
+    Chromosome::set_seed(first_seed + r), so every replicate draws from its
+    own random number streams and any replicate can be reproduced on its own
+    by using the same seed.  Worker threads take the next unstarted replicate
+    as they become free, and each result is stored at its replicate's index,
+    so results come back in replicate order whatever the number of threads.
+
+    T_RESULT must be default-constructible and assignable.  The replicate
+    function is called as f(C, r) and returns a T_RESULT; it is called from
+    several threads at once so must not touch shared state without locking.
+    Chromosomes print repair diagnostics by default, so f will usually want
+    to call C.set_debug_repair(0).
+ */
+template<class T_RESULT>
+class Replicates {
+
+    private:
+
+        long                    _num_replicates;
+        unsigned                _num_threads;
+        unsigned long           _first_seed;
+        std::vector<T_RESULT>   Results;
+
+        template<class F>
+        void
+        worker(F& f, std::atomic<long>& next)
+        {
+            long r;
+            while ((r = next++) < _num_replicates) {
+                Chromosome C;
+                C.set_seed(_first_seed + r);
+                Results[r] = f(C, r);
+            }
+        };
+
+    public:
+
+        /*! constructor
+
+            @param nr   number of replicates
+            @param nt   number of threads, 0 for the number of hardware threads
+            @param fs   seed of the first replicate
+         */
+        Replicates(const long nr, const unsigned nt = 0,
+                   const unsigned long fs = 0)
+            : _num_replicates(nr), _num_threads(nt), _first_seed(fs)
+        {
+            if (_num_threads == 0) 
+                _num_threads = std::thread::hardware_concurrency();
+            if (_num_threads == 0) _num_threads = 1;
+            if (_first_seed + _num_replicates > Chromosome::max_seed()) {
+                std::cerr << "Replicates<> : seeds must be less than "
+                    << Chromosome::max_seed() << std::endl;
+            }
+            assert(_first_seed + _num_replicates <= Chromosome::max_seed());
+        };
+
+        long      num_replicates() const { return(_num_replicates); };
+        unsigned  num_threads() const    { return(_num_threads); };
+
+        /*! Run all replicates, returning their results in replicate order
+
+            @param f    replicate function, T_RESULT f(Chromosome&, long)
+         */
+        template<class F>
+        const std::vector<T_RESULT>&
+        run(F f)
+        {
+            Results.assign(_num_replicates, T_RESULT());
+            std::atomic<long> next(0);
+            unsigned nt = _num_threads;
+            if (static_cast<long>(nt) > _num_replicates) nt = _num_replicates;
+            std::vector<std::thread> threads;
+            for (unsigned t = 1; t < nt; ++t)
+                threads.push_back(std::thread(&Replicates::worker<F>, this,
+                                              std::ref(f), std::ref(next)));
+            worker(f, next);  // the calling thread works too
+            for (size_t t = 0; t < threads.size(); ++t) threads[t].join();
+            return(Results);
+        };
+
+        const std::vector<T_RESULT>& results() const { return(Results); };
+};
+
+#endif // REPLICATES_H
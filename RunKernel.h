@@ -0,0 +1,123 @@
+#ifndef RUNKERNEL_H
+#define RUNKERNEL_H
+
+#include <cstddef>
+#include <limits>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/*! @class RunKernel
+
+    @brief Find where runs of identical items begin, a block at a time.
+
+    find() writes each position i in [first, last) at which v[i] differs
+    from v[i - 1], in increasing order, so the runs of v are the spans
+    between successive positions found.  For integral items of 1, 2, 4 or 8
+    bytes, with SSE2, v[i .. i + 15] is compared with v[i - 1 .. i + 14] as
+    vectors, the results are packed into a 16-bit mask with movemask, and
+    the positions of its set bits are taken off one at a time with a count
+    of trailing zeros.  Within a long run the mask is empty and sixteen
+    items are passed over in a few instructions.  Other items, and builds
+    without SSE2, compare one item at a time.
+ */
+template<class T_ITEM>
+class RunKernel {
+
+    private:
+
+        static size_t
+        find_scalar(const T_ITEM* v, size_t i, const size_t last, size_t* out)
+        {
+            size_t n = 0;
+            for ( ; i < last; ++i) {
+                out[n] = i;
+                n += (v[i] != v[i - 1]);
+            }
+            return(n);
+        };
+
+#if defined(__SSE2__)
+        // bit k of the mask is set if v[i + k] == v[i + k - 1], k < 16
+        static unsigned
+        equal_mask(const T_ITEM* v, const size_t i)
+        {
+            const __m128i* a = reinterpret_cast<const __m128i*>(v + i);
+            const __m128i* b = reinterpret_cast<const __m128i*>(v + i - 1);
+            switch (sizeof(T_ITEM)) {
+                case 1:
+                    return(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128(a),
+                                                            _mm_loadu_si128(b))));
+                case 2: {
+                    __m128i e0 = _mm_cmpeq_epi16(_mm_loadu_si128(a), _mm_loadu_si128(b));
+                    __m128i e1 = _mm_cmpeq_epi16(_mm_loadu_si128(a + 1),
+                                                 _mm_loadu_si128(reinterpret_cast<const __m128i*>(v + i + 7)));
+                    return(_mm_movemask_epi8(_mm_packs_epi16(e0, e1)));
+                }
+                case 4: {
+                    __m128i e[4];
+                    for (int k = 0; k < 4; ++k)
+                        e[k] = _mm_cmpeq_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(v + i + 4 * k)),
+                                               _mm_loadu_si128(reinterpret_cast<const __m128i*>(v + i + 4 * k - 1)));
+                    return(_mm_movemask_epi8(_mm_packs_epi16(_mm_packs_epi32(e[0], e[1]),
+                                                             _mm_packs_epi32(e[2], e[3]))));
+                }
+                default: {
+                    // no 64-bit compare in SSE2: both 32-bit halves must match
+                    unsigned mask = 0;
+                    for (int k = 0; k < 8; ++k) {
+                        __m128i e = _mm_cmpeq_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(v + i + 2 * k)),
+                                                    _mm_loadu_si128(reinterpret_cast<const __m128i*>(v + i + 2 * k - 1)));
+                        e = _mm_and_si128(e, _mm_shuffle_epi32(e, _MM_SHUFFLE(2, 3, 0, 1)));
+                        mask |= unsigned(_mm_movemask_pd(_mm_castsi128_pd(e))) << (2 * k);
+                    }
+                    return(mask);
+                }
+            }
+        };
+#endif
+
+    public:
+
+        //! Whether find() compares a vector of items at a time
+        static bool
+        vectorised()
+        {
+#if defined(__SSE2__)
+            return(std::numeric_limits<T_ITEM>::is_integer &&
+                   (sizeof(T_ITEM) == 1 || sizeof(T_ITEM) == 2 ||
+                    sizeof(T_ITEM) == 4 || sizeof(T_ITEM) == 8));
+#else
+            return(false);
+#endif
+        };
+
+        /*! Find run starts within [first, last)
+
+            @param v      items
+            @param first  first position to test, >= 1
+            @param last   one past the last position to test
+            @param out    receives the positions found, room for
+                          last - first of them
+            @return       number of positions found
+         */
+        static size_t
+        find(const T_ITEM* v, const size_t first, const size_t last, size_t* out)
+        {
+            if (first >= last) return(0);
+            if (! vectorised()) return(find_scalar(v, first, last, out));
+            size_t n = 0, i = first;
+#if defined(__SSE2__)
+            for ( ; i + 16 <= last; i += 16) {
+                unsigned diff = ~equal_mask(v, i) & 0xFFFF;
+                while (diff) {
+                    out[n++] = i + __builtin_ctz(diff);
+                    diff &= diff - 1;
+                }
+            }
+#endif
+            return(n + find_scalar(v, i, last, out + n));
+        };
+};
+
+#endif // RUNKERNEL_H
@@ -0,0 +1,339 @@
+#ifndef RUNMAP_H
+#define RUNMAP_H
+
+#include <map>
+#include <vector>
+#include <string>
+#include <cassert>
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include "Histogram.h"
+#include "LogHistogram.h"
+
+/*! @class RunMap
+
+    @brief Runs of identical items in a sequence, kept up to date as the
+           sequence changes.
+
+    Where SequenceRuns scans a whole sequence to find its runs, RunMap holds
+    the runs themselves, as a balanced tree mapping the position at which
+    each run starts to its item; a run ends where the next begins.  Changing
+    a single site or assigning a range splits the runs at the ends of the
+    change, removes the runs inside it and merges the result with equal
+    neighbours, in O(log runs) plus the number of runs removed.
+
+    Per-item run statistics (number of runs, sum and sum of squares of run
+    lengths, and a count of runs of each length) are updated along with
+    every split and merge, so summary statistics and run-length histograms
+    are available at any time without scanning the sequence.
+
+    Positions are numbered from 0 and ranges are half-open, [first, last).
+ */
+template<class T_ITEM, class T_COUNT>
+class RunMap {
+
+    public:
+
+        //! run-length statistics for one item value
+        struct ItemStats {
+            long                        num_runs;
+            long                        sum;     // of run lengths
+            unsigned __int128           sum_sq;  // of squared run lengths
+            std::map<T_COUNT, long>     Lengths; // run length -> number of runs
+
+            ItemStats() : num_runs(0), sum(0), sum_sq(0) { };
+
+            double mean() const { return(double(sum) / num_runs); };
+            //! sample variance, as VectorUtility::Var(), 0 for fewer than
+            //! two runs
+            double
+            var() const 
+            {
+                if (num_runs < 2) return(0.0);
+                // n sum_sq - sum^2 is exact in integers, and never negative
+                const unsigned __int128 n = num_runs, s = sum;
+                return(double(n * sum_sq - s * s) / 
+                       (double(num_runs) * double(num_runs - 1)));
+            };
+            T_COUNT min() const { return(Lengths.begin()->first); };
+            T_COUNT max() const { return(Lengths.rbegin()->first); };
+        };
+
+        typedef std::map<T_COUNT, T_ITEM>                    run_map_type;
+        typedef typename run_map_type::iterator              run_map_I;
+        typedef typename run_map_type::const_iterator        run_map_CI;
+        typedef std::map<T_ITEM, ItemStats>                  stats_type;
+        typedef typename stats_type::const_iterator          stats_type_CI;
+
+    private:
+
+        T_COUNT         _size;
+        run_map_type    Starts;  // start of each run -> its item
+        stats_type      Stats;
+
+        void
+        add_run(const T_ITEM& item, const T_COUNT length)
+        {
+            ItemStats& s = Stats[item];
+            ++s.num_runs;
+            s.sum += length;
+            s.sum_sq += (unsigned __int128)length * length;
+            ++s.Lengths[length];
+        };
+
+        void
+        remove_run(const T_ITEM& item, const T_COUNT length)
+        {
+            ItemStats& s = Stats[item];
+            --s.num_runs;
+            s.sum -= length;
+            s.sum_sq -= (unsigned __int128)length * length;
+            typename std::map<T_COUNT, long>::iterator p = s.Lengths.find(length);
+            assert(p != s.Lengths.end());
+            if (--p->second == 0) s.Lengths.erase(p);
+            if (s.num_runs == 0) Stats.erase(item);
+        };
+
+        T_COUNT
+        end_of(run_map_CI p) const
+        {
+            ++p;
+            return(p == Starts.end() ? _size : p->first);
+        };
+
+        //! run containing pos, 0 <= pos < size()
+        run_map_I
+        find_run(const T_COUNT pos)
+        {
+            run_map_I p = Starts.upper_bound(pos);
+            return(--p);
+        };
+
+        //! make sure a run starts at pos, 0 < pos < size()
+        void
+        split(const T_COUNT pos)
+        {
+            run_map_I p = find_run(pos);
+            if (p->first == pos) return;
+            T_COUNT start = p->first, end = end_of(p);
+            T_ITEM item = p->second;
+            remove_run(item, end - start);
+            add_run(item, pos - start);
+            add_run(item, end - pos);
+            Starts.insert(p, std::make_pair(pos, item));
+        };
+
+        //! merge the run starting at p with the run before it if equal
+        void
+        merge_left(run_map_I p)
+        {
+            if (p == Starts.begin() || p == Starts.end()) return;
+            run_map_I q = p; --q;
+            if (q->second != p->second) return;
+            T_COUNT end = end_of(p);
+            remove_run(q->second, p->first - q->first);
+            remove_run(p->second, end - p->first);
+            add_run(q->second, end - q->first);
+            Starts.erase(p);
+        };
+
+    public:
+
+        RunMap() : _size(0) { };
+
+        //! construct with n copies of item
+        RunMap(const T_COUNT n, const T_ITEM& item) : _size(0)
+        { assign(n, item); };
+
+        //! construct from a sequence
+        RunMap(const std::vector<T_ITEM>& Vec) : _size(0)
+        { fill(Vec); };
+
+        T_COUNT   size() const      { return(_size); };
+        long      num_runs() const  { return(Starts.size()); };
+
+        //! Reset to n copies of item, a single run
+        void
+        assign(const T_COUNT n, const T_ITEM& item)
+        {
+            Starts.clear();
+            Stats.clear();
+            _size = n;
+            if (n == 0) return;
+            Starts[0] = item;
+            add_run(item, n);
+        };
+
+        /*! Reset from any sequence of n items, get(i) giving item i
+
+            @param n    number of items
+            @param get  function object, get(i) returns the item at i
+         */
+        template<class F>
+        void
+        fill(const T_COUNT n, F get)
+        {
+            Starts.clear();
+            Stats.clear();
+            _size = n;
+            if (n == 0) return;
+            T_ITEM prev = get(0);
+            T_COUNT start = 0;
+            run_map_I hint = Starts.end();
+            for (T_COUNT i = 1; i < n; ++i) {
+                T_ITEM item = get(i);
+                if (item == prev) continue;
+                hint = Starts.insert(hint, std::make_pair(start, prev));
+                add_run(prev, i - start);
+                prev = item;
+                start = i;
+            }
+            Starts.insert(hint, std::make_pair(start, prev));
+            add_run(prev, n - start);
+        };
+
+        void
+        fill(const std::vector<T_ITEM>& Vec)
+        { fill(T_COUNT(Vec.size()), VectorGet(Vec)); };
+
+        //! Item at pos
+        T_ITEM
+        get(const T_COUNT pos) const
+        {
+            assert(pos >= 0 && pos < _size);
+            run_map_CI p = Starts.upper_bound(pos);
+            return((--p)->second);
+        };
+
+        //! Set the item at pos
+        void
+        set(const T_COUNT pos, const T_ITEM& item)
+        { assign_range(pos, pos + 1, item); };
+
+        //! Set every item in [first, last) to item
+        void
+        assign_range(const T_COUNT first, const T_COUNT last, const T_ITEM& item)
+        {
+            assert(first >= 0 && first <= last && last <= _size);
+            if (first == last) return;
+            // a quick exit for the common case of no change
+            run_map_I p = find_run(first);
+            if (p->second == item && end_of(p) >= last) return;
+            if (first > 0) split(first);
+            if (last < _size) split(last);
+            p = Starts.find(first);
+            while (p != Starts.end() && p->first < last) {
+                remove_run(p->second, end_of(p) - p->first);
+                Starts.erase(p++);
+            }
+            p = Starts.insert(p, std::make_pair(first, item));
+            add_run(item, last - first);
+            run_map_I next = p; ++next;
+            merge_left(next);
+            merge_left(p);
+        };
+
+        const run_map_type&   get_starts() const  { return(Starts); };
+        const stats_type&     get_stats() const   { return(Stats); };
+
+        //! Runs of item, with the same columns as SequenceRuns
+        void
+        print_summary_stats(std::ostream& os = std::cout,
+                            const bool header = true,
+                            const std::string& prefix = "") const
+        {
+            if (header) {
+                os << "RunMap:: Summary Statistics" << std::endl;
+                os << "===========================" << std::endl;
+                os << prefix;
+                os << "item_val";
+                os << "\t" << "num_sites";
+                os << "\t" << "freq";
+                os << "\t" << "min_run";
+                os << "\t" << "max_run";
+                os << "\t" << "mean_run";
+                os << "\t" << "var_run";
+                os << std::endl;
+            }
+            for (stats_type_CI p = Stats.begin(); p != Stats.end(); ++p) {
+                const ItemStats& s = p->second;
+                os << prefix;
+                os << p->first;
+                os << "\t" << s.sum;
+                os << "\t" << (double(s.sum) / _size);
+                os << "\t" << s.min();
+                os << "\t" << s.max();
+                os << "\t" << s.mean();
+                os << "\t" << s.var();
+                os << std::endl;
+            }
+        };
+
+        //! Run length histograms of each item, observed lengths only
+        void
+        print_histograms(std::ostream& os = std::cout,
+                         const bool header = true,
+                         const std::string& prefix = "") const
+        {
+            if (header) {
+                os << "RunMap:: Runs Length Histogram" << std::endl;
+                os << "==============================" << std::endl;
+                os << prefix;
+                os << "item_val";
+                os << "\t" << "run_length";
+                os << "\t" << "count";
+                os << "\t" << "freq";
+                os << std::endl;
+            }
+            for (stats_type_CI p = Stats.begin(); p != Stats.end(); ++p) {
+                Histogram<T_COUNT, T_COUNT> hist;
+                typename std::map<T_COUNT, long>::const_iterator q;
+                for (q = p->second.Lengths.begin(); q != p->second.Lengths.end(); ++q)
+                    hist.add(q->first, q->second);
+                std::ostringstream ost;
+                ost << prefix << p->first << "\t";
+                hist.print_table(os, false, ost.str());
+            }
+        };
+
+        //! Run length histograms of each item in logarithmic bins, see
+        //! LogHistogram
+        void
+        print_log_histograms(std::ostream& os = std::cout,
+                             const bool header = true,
+                             const std::string& prefix = "",
+                             const unsigned sub_bits = 3) const
+        {
+            if (header) {
+                os << "RunMap:: Runs Length Log Histogram" << std::endl;
+                os << "==================================" << std::endl;
+                os << prefix;
+                os << "item_val";
+                os << "\t" << "run_length_start";
+                os << "\t" << "run_length_end";
+                os << "\t" << "count";
+                os << "\t" << "freq";
+                os << std::endl;
+            }
+            for (stats_type_CI p = Stats.begin(); p != Stats.end(); ++p) {
+                LogHistogram<T_COUNT, long> hist(sub_bits);
+                typename std::map<T_COUNT, long>::const_iterator q;
+                for (q = p->second.Lengths.begin(); q != p->second.Lengths.end(); ++q)
+                    hist.add(q->first, q->second);
+                std::ostringstream ost;
+                ost << prefix << p->first << "\t";
+                hist.print_table(os, false, ost.str());
+            }
+        };
+
+    private:
+
+        struct VectorGet {
+            const std::vector<T_ITEM>& V;
+            VectorGet(const std::vector<T_ITEM>& v) : V(v) { };
+            T_ITEM operator()(const T_COUNT i) const { return(V[i]); };
+        };
+};
+
+#endif // RUNMAP_H
@@ -5,12 +5,15 @@
 #include <string>
 #include <map>
 #include <utility>
+#include <thread>
+#include <functional>
 #include <cassert>
 #include <typeinfo>
 #include <iostream>
 #include <sstream>
 #include "VectorUtility.h"
 #include "Histogram.h"
+#include "RunKernel.h"
 
 //template<class T_ITEM>
 //class Runs : public class InternalRuns<T_ITEM, Scalar>;
@@ -20,6 +23,22 @@
 //class InternalRuns {
 //};
 
+/*! @class SequenceRuns
+
+    @brief Runs of identical items in a sequence, found by scanning it.
+
+    Runs are kept as columns: the position, length and item of run i are
+    element i of each of three vectors, and run i has run_index i.  For
+    each item, the indices of its runs are kept in order.  The columns, and
+    the lengths of the runs of one item read through its index list, are
+    available as VectorViews, which VectorUtility and Histogram take
+    directly, so nothing is copied to summarise them.  Views are valid
+    until the runs next change.
+
+    A long chunk can be split among threads with add_chunk(v, n, nt); runs
+    crossing the seams between threads are joined, and the runs and their
+    indices are the same as from one thread.
+ */
 template<class T_ITEM, class T_COUNT>
 class SequenceRuns {
     public:
@@ -48,34 +67,49 @@ class SequenceRuns {
                 };
         };
 
-        typedef typename std::vector<T_ITEM>                     item_list_type;
-        typedef typename std::vector<T_COUNT>                    run_list_type;
+        typedef VectorView<T_ITEM>                               item_list_type;
+        typedef VectorView<T_COUNT>                              run_list_type;
+        typedef VectorView<long>                                 index_list_type;
         typedef typename std::map<T_ITEM, std::vector<T_COUNT> > map_type;
         typedef typename map_type::const_iterator                map_type_CI;
-        typedef typename std::map<T_ITEM, T_COUNT>               unique_item_type;
-        typedef typename unique_item_type::const_iterator        unique_item_type_CI;
-        typedef typename std::vector<Run>                        Runs_type;
+        typedef typename std::map<T_ITEM, std::vector<long> >    item_runs_type;
+        typedef typename item_runs_type::const_iterator          item_runs_type_CI;
 
-        SequenceRuns(const std::vector<T_ITEM>& Vec)
-            : _debug_trace(false), num_runs(0), total_items(0)
+        //! Runs of Vec, found with nt threads as for add_chunk()
+        SequenceRuns(const std::vector<T_ITEM>& Vec, const unsigned nt = 1)
+            : _debug_trace(false), num_runs(0), total_items(0), _open(false)
         {
-            _trace("CONSTRUCTOR ( Vec )");
+            _trace("CONSTRUCTOR ( Vec, nt )");
             if (Vec.size() == 0) {
                 std::cerr << "SequenceRuns<>::CONSTRUCTOR : no values" << std::endl;
                 exit(1);
             }
             names("item", "run_length");
-            fill(Vec);
+            fill(Vec, nt);
+        };
+
+        //! Constructor for runs to be read a chunk at a time, see start()
+        SequenceRuns()
+            : _debug_trace(false), num_runs(0), total_items(0), _open(false)
+        {
+            _trace("CONSTRUCTOR ( )");
+            names("item", "run_length");
         };
 
     private:
-        unique_item_type  unique_items;  // entry for each T_ITEM value
         long              num_runs;
         long              total_items;  // total number of items seen
-        Runs_type         Runs;  // vector to which RunsList is converted
-        map_type          Map;  // map of runs
+        std::vector<T_COUNT>  Positions;  // run columns, indexed by run_index
+        std::vector<T_COUNT>  Lengths;
+        std::vector<T_ITEM>   Items;
+        item_runs_type    ItemRuns;  // indices of the runs of each item
+        map_type          Map;  // run lengths of each item, see get_map()
         std::string       item_name;
         std::string       run_name;
+        // the last run seen, which the next chunk may continue
+        bool              _open;
+        T_ITEM            _open_item;
+        long              _open_position;
 
         void _trace(const std::string& s) const {
             if (_debug_trace) {
@@ -85,28 +119,143 @@ class SequenceRuns {
             }
         };
 
-        void _fill(const std::vector<T_ITEM>& Vec, const long start_run_index);
+        // run index list of one item, found through a short list of
+        // recent items before the map, which for the few item values of a
+        // sequence avoids a tree lookup per run
+        struct ItemSlot {
+            T_ITEM                  item;
+            std::vector<long>*      runs;
+        };
+
+        static ItemSlot& slot(std::vector<ItemSlot>& Slots, item_runs_type& R,
+                              const T_ITEM& item)
+        {
+            for (size_t i = 0; i < Slots.size(); ++i)
+                if (Slots[i].item == item) return(Slots[i]);
+            ItemSlot s = { item, &R[item] };
+            if (Slots.size() == 8) Slots.pop_back();
+            Slots.insert(Slots.begin(), s);
+            return(Slots[0]);
+        };
+
+        // least items per thread worth starting a thread for
+        static const size_t min_per_thread = size_t(1) << 16;
+
+        void _fill(const T_ITEM* v, const size_t n);
+        void _fill_parallel(const T_ITEM* v, const size_t n, const unsigned nt);
+        static void _find_starts(const T_ITEM* v, const size_t first,
+                                 const size_t last, std::vector<size_t>& starts);
+        void _write_runs(const T_ITEM* v, const std::vector<size_t>& starts,
+                         const size_t offset, const size_t next,
+                         const size_t num, const long base,
+                         item_runs_type& Local);
+        void _note_run(std::vector<ItemSlot>& Slots, const long end);
 
     public:
         void names(const std::string& in = "", const std::string& rn = "")
         { _trace("names ( in, rn )"); item_name = in; run_name = rn; };
 
-        void fill(const std::vector<T_ITEM>& Vec)
+        /*! Runs can be found a chunk of the sequence at a time: start(),
+            then add_chunk() or read_chunks() for each part of the sequence
+            in order, then finish().  A run continuing from one chunk into
+            the next is joined into one, and positions count from the start
+            of the whole sequence.  Only runs are stored, so memory is
+            proportional to the number of runs however long the sequence,
+            which need never be in memory at once; chunks may come from a
+            file, a mapping of one (see MappedFile) or segments of a
+            Chromosome (see Chromosome::get_segment()).
+         */
+        void start()
+        {
+            _trace("start ( )");
+            Positions.clear();
+            Lengths.clear();
+            Items.clear();
+            ItemRuns.clear();
+            Map.clear();
+            num_runs = 0;
+            total_items = 0;
+            _open = false;
+        };
+
+        /*! Add the next n items of the sequence
+
+            @param v    items
+            @param n    number of items
+            @param nt   number of threads (1), 0 for the number of hardware
+                        threads; each finds the runs in a segment of the
+                        items, and the segments are joined, with the same
+                        result, run indices included, as with one thread
+         */
+        void add_chunk(const T_ITEM* v, const size_t n, unsigned nt = 1)
         {
-            _trace("fill ( Vec )");
-            Runs.clear();
-            Runs.resize(Vec.size());
-            _fill(Vec, 0);
-            total_items = Vec.size();
+            _trace("add_chunk ( v, n, nt )");
+            if (nt == 0) nt = std::thread::hardware_concurrency();
+            if (nt == 0) nt = 1;
+            if (nt > n / min_per_thread) nt = n / min_per_thread;
+            if (nt <= 1) _fill(v, n);
+            else _fill_parallel(v, n, nt);
         };
 
+        void add_chunk(const std::vector<T_ITEM>& Vec, const unsigned nt = 1)
+        { if (! Vec.empty()) add_chunk(&Vec[0], Vec.size(), nt); };
+
+        /*! Add the rest of the sequence from a stream of raw T_ITEM values,
+            chunk_size items at a time, returning false if it ends partway
+            through an item
+         */
+        bool read_chunks(std::istream& is, const size_t chunk_size = 1 << 20)
+        {
+            _trace("read_chunks ( is, chunk_size )");
+            std::vector<T_ITEM> chunk(chunk_size);
+            const std::streamsize bytes = chunk_size * sizeof(T_ITEM);
+            while (is) {
+                is.read(reinterpret_cast<char*>(&chunk[0]), bytes);
+                const std::streamsize got = is.gcount();
+                if (got % sizeof(T_ITEM) != 0) return(false);
+                add_chunk(&chunk[0], got / sizeof(T_ITEM));
+            }
+            return(is.eof());
+        };
+
+        //! Close the last run, after which the runs are complete
+        void finish()
+        {
+            _trace("finish ( )");
+            if (! _open) return;
+            std::vector<ItemSlot> Slots;
+            _note_run(Slots, total_items);
+            _open = false;
+        };
+
+        void fill(const std::vector<T_ITEM>& Vec, const unsigned nt = 1)
+        {
+            _trace("fill ( Vec, nt )");
+            start();
+            add_chunk(Vec, nt);
+            finish();
+        };
+
+        //! Continue the sequence with Vec, joining its first run to the
+        //! last run so far if they are of the same item
         void append(const std::vector<T_ITEM>& Vec)
         {
             _trace("append ( Vec )");
-            if (Runs.size() < num_runs + Vec.size())
-                { Runs.resize(num_runs + Vec.size()); }
-            _fill(Vec, num_runs);
-            total_items += Vec.size();
+            if (! _open && num_runs > 0) {
+                // reopen the last run
+                _open = true;
+                _open_item = Items.back();
+                _open_position = Positions.back();
+                typename item_runs_type::iterator m = ItemRuns.find(_open_item);
+                m->second.pop_back();
+                if (m->second.empty()) ItemRuns.erase(m);
+                Positions.pop_back();
+                Lengths.pop_back();
+                Items.pop_back();
+                --num_runs;
+            }
+            add_chunk(Vec);
+            finish();
         };
 
         // Produce statistics on runs
@@ -129,18 +278,20 @@ class SequenceRuns {
                 os << "\t" << "var_run";
                 os << std::endl;
             }
-            for (map_type_CI p = Map.begin(); p != Map.end(); ++p) {
+            for (item_runs_type_CI p = ItemRuns.begin(); p != ItemRuns.end(); ++p) {
                 if (p->second.size() == 0) {
                     os << prefix;
                     os << p->first << "\tNA\tNA\tNA\tNA\tNA\tNA" << std::endl;
                 }
                 // for item value p->first, produce statistics from
-                // the vector of run lengths in p->second
-                double sum = VectorUtility::Sum(p->second);
-                T_ITEM min = VectorUtility::Min(p->second);
-                T_ITEM max = VectorUtility::Max(p->second);
-                double mean = VectorUtility::Mean(p->second);
-                double var = VectorUtility::Var(p->second);
+                // its run lengths, read in place in one pass
+                const VectorUtility::Moments<T_COUNT> m =
+                    VectorUtility::Summarize(get_item_lengths(p->first));
+                double sum = m.sum();
+                T_ITEM min = m.min();
+                T_ITEM max = m.max();
+                double mean = m.mean();
+                double var = m.var();
                 os << prefix;
                 os << p->first;
                 os << "\t" << sum;
@@ -168,12 +319,12 @@ class SequenceRuns {
                 os << "\t" << "freq";
                 os << std::endl;
             }
-            for (map_type_CI p = Map.begin(); p != Map.end(); ++p) {
+            for (item_runs_type_CI p = ItemRuns.begin(); p != ItemRuns.end(); ++p) {
                 if (p->second.size() == 0) {
                     os << prefix;
                     os << p->first << "\tNA\tNA\tNA" << std::endl;
                 }
-                Histogram<T_COUNT, T_COUNT> hist(p->second, false);
+                Histogram<T_COUNT, T_COUNT> hist(get_item_lengths(p->first), false);
                 std::ostringstream ost;
                 ost << p->first << "\t";
                 hist.print_table(os, false, ost.str());
@@ -184,10 +335,21 @@ class SequenceRuns {
 
         // Accessory data items //
         //
+        long            get_num_runs() const    { return(num_runs); };
+        Run             get_run(const long i) const;
+        run_list_type   get_positions() const   { return(run_list_type(Positions)); };
+        run_list_type   get_lengths() const     { return(run_list_type(Lengths)); };
+        item_list_type  get_items() const       { return(item_list_type(Items)); };
+        //! indices of the runs of item, in order
+        index_list_type get_item_runs(const T_ITEM& item) const;
+        //! lengths of the runs of item, in order, read through its indices
+        run_list_type   get_item_lengths(const T_ITEM& item) const;
+        //! copies the run lengths of each item into Map; prefer
+        //! get_item_lengths(), which copies nothing
         void build_map();
         const map_type& get_map();
-        const item_list_type get_item_list() const;
-        const run_list_type get_run_list() const;
+        item_list_type  get_item_list() const   { return(get_items()); };
+        run_list_type   get_run_list() const    { return(get_lengths()); };
 
         // Print routines //
         //
@@ -214,38 +376,193 @@ class SequenceRuns {
         };
 };
 
+// Runs are found a block of the chunk at a time by RunKernel, which
+// writes the positions at which runs start into a small buffer; the open
+// run is noted as each start ends it.  The last run of the chunk is left
+// open for the next chunk, or finish(), to end.
 template<class T_ITEM, class T_COUNT>
 void
-SequenceRuns<T_ITEM, T_COUNT>::_fill(const std::vector<T_ITEM>& Vec, 
-                                     const long start_run_index)
+SequenceRuns<T_ITEM, T_COUNT>::_fill(const T_ITEM* v, const size_t n)
 {
-    _trace("_fill ( Vec, start_run_index )");
-    long run_index = start_run_index;
-    T_ITEM prev = Vec[0];
-    T_COUNT run_position = 0;
-    T_COUNT thisrunlength = 1;
-    for (long i = 1; i < Vec.size(); ++i) {
-        if (Vec[i] == prev) { ++thisrunlength; }
-        else {
-            // note the run
-            Runs[run_index].item = prev;
-            Runs[run_index].length = thisrunlength;
-            Runs[run_index].position = run_position;
-            Runs[run_index].run_index = run_index;
-            unique_items[prev]++;
-            ++run_index;
-            prev = Vec[i];
-            run_position = i;
-            thisrunlength = 1;
+    _trace("_fill ( v, n )");
+    if (n == 0) return;
+    std::vector<ItemSlot> Slots;
+    if (_open && v[0] != _open_item) {
+        _note_run(Slots, total_items);
+        _open = false;
+    }
+    if (! _open) {
+        _open = true;
+        _open_item = v[0];
+        _open_position = total_items;
+    }
+    const size_t block = 4096;
+    std::vector<size_t> starts(block);
+    for (size_t first = 1; first < n; first += block) {
+        const size_t last = VectorUtility::Min(first + block, n);
+        const size_t num = RunKernel<T_ITEM>::find(v, first, last, &starts[0]);
+        for (size_t k = 0; k < num; ++k) {
+            _note_run(Slots, total_items + starts[k]);
+            _open_item = v[starts[k]];
+            _open_position = total_items + starts[k];
         }
     }
-    Runs[run_index].item = prev;
-    Runs[run_index].length = thisrunlength;
-    Runs[run_index].position = run_position;
-    Runs[run_index].run_index = run_index;
-    unique_items[prev]++;
-    num_runs = run_index + 1;
-    build_map();
+    total_items += n;
+};
+
+// Runs of a chunk found on nt threads.  Each thread finds the run starts
+// in its own segment of the chunk, testing the first item of the segment
+// against the last item of the segment before, so the starts of all the
+// segments in order are the starts of the whole chunk.  The columns are
+// then sized for every run, and each thread writes the runs starting in
+// its segment at their final indices, collecting run index lists of its
+// own, which are appended to ItemRuns one segment after another.  The
+// result is exactly that of _fill().
+template<class T_ITEM, class T_COUNT>
+void
+SequenceRuns<T_ITEM, T_COUNT>::_fill_parallel(const T_ITEM* v, const size_t n,
+                                              const unsigned nt)
+{
+    _trace("_fill_parallel ( v, n, nt )");
+    std::vector<std::vector<size_t> > Starts(nt);
+    std::vector<std::thread> threads;
+    for (unsigned t = 1; t < nt; ++t)
+        threads.push_back(std::thread(&SequenceRuns::_find_starts, v, n * t / nt,
+                                      n * (t + 1) / nt, std::ref(Starts[t])));
+    _find_starts(v, 0, n / nt, Starts[0]);
+    for (size_t t = 0; t < threads.size(); ++t) threads[t].join();
+    threads.clear();
+
+    std::vector<ItemSlot> Slots;
+    if (_open && v[0] != _open_item) {
+        _note_run(Slots, total_items);
+        _open = false;
+    }
+    if (! _open) {
+        _open = true;
+        _open_item = v[0];
+        _open_position = total_items;
+    }
+    // offset[t] starts precede segment t; next[t] is the first start after
+    // segment t, or n
+    std::vector<size_t> offset(nt + 1, 0), next(nt, n);
+    for (unsigned t = 0; t < nt; ++t) offset[t + 1] = offset[t] + Starts[t].size();
+    for (unsigned t = nt - 1; t > 0; --t)
+        next[t - 1] = Starts[t].empty() ? next[t] : Starts[t][0];
+    const size_t num = offset[nt];
+    if (num == 0) { total_items += n; return; }
+    const size_t first_start = Starts[0].empty() ? next[0] : Starts[0][0];
+    _note_run(Slots, total_items + first_start);
+
+    // the run at the last start stays open
+    const long base = num_runs;
+    Positions.resize(base + num - 1);
+    Lengths.resize(base + num - 1);
+    Items.resize(base + num - 1);
+    std::vector<item_runs_type> Local(nt);
+    for (unsigned t = 1; t < nt; ++t)
+        threads.push_back(std::thread(&SequenceRuns::_write_runs, this, v,
+                                      std::cref(Starts[t]), offset[t], next[t],
+                                      num - 1, base, std::ref(Local[t])));
+    _write_runs(v, Starts[0], offset[0], next[0], num - 1, base, Local[0]);
+    for (size_t t = 0; t < threads.size(); ++t) threads[t].join();
+    for (unsigned t = 0; t < nt; ++t) {
+        for (item_runs_type_CI p = Local[t].begin(); p != Local[t].end(); ++p) {
+            std::vector<long>& R = ItemRuns[p->first];
+            R.insert(R.end(), p->second.begin(), p->second.end());
+        }
+    }
+    num_runs = base + num - 1;
+
+    unsigned last_t = nt - 1;
+    while (Starts[last_t].empty()) --last_t;
+    _open_item = v[Starts[last_t].back()];
+    _open_position = total_items + Starts[last_t].back();
+    total_items += n;
+};
+
+// Append the run starts within [first, last) of v to starts
+template<class T_ITEM, class T_COUNT>
+void
+SequenceRuns<T_ITEM, T_COUNT>::_find_starts(const T_ITEM* v, const size_t first,
+                                            const size_t last,
+                                            std::vector<size_t>& starts)
+{
+    const size_t block = 4096;
+    std::vector<size_t> buf(block);
+    for (size_t f = VectorUtility::Max(first, size_t(1)); f < last; f += block) {
+        const size_t l = VectorUtility::Min(f + block, last);
+        const size_t k = RunKernel<T_ITEM>::find(v, f, l, &buf[0]);
+        starts.insert(starts.end(), buf.begin(), buf.begin() + k);
+    }
+};
+
+// Write the runs beginning at starts, which are run starts offset onwards
+// of the chunk, at indices base + offset onwards, stopping before start
+// num; the last of them ends at next
+template<class T_ITEM, class T_COUNT>
+void
+SequenceRuns<T_ITEM, T_COUNT>::_write_runs(const T_ITEM* v,
+                                           const std::vector<size_t>& starts,
+                                           const size_t offset, const size_t next,
+                                           const size_t num, const long base,
+                                           item_runs_type& Local)
+{
+    std::vector<ItemSlot> Slots;
+    for (size_t k = 0; k < starts.size() && offset + k < num; ++k) {
+        const size_t s = starts[k];
+        const size_t e = (k + 1 < starts.size()) ? starts[k + 1] : next;
+        const long i = base + offset + k;
+        Positions[i] = total_items + s;
+        Lengths[i] = e - s;
+        Items[i] = v[s];
+        slot(Slots, Local, v[s]).runs->push_back(i);
+    }
+};
+
+// Note the open run, which ends before position end, in the columns and
+// the run index list of its item
+template<class T_ITEM, class T_COUNT>
+void
+SequenceRuns<T_ITEM, T_COUNT>::_note_run(std::vector<ItemSlot>& Slots,
+                                         const long end)
+{
+    Positions.push_back(_open_position);
+    Lengths.push_back(end - _open_position);
+    Items.push_back(_open_item);
+    slot(Slots, ItemRuns, _open_item).runs->push_back(num_runs++);
+};
+
+template<class T_ITEM, class T_COUNT>
+typename SequenceRuns<T_ITEM, T_COUNT>::Run
+SequenceRuns<T_ITEM, T_COUNT>::get_run(const long i) const
+{
+    Run R;
+    R.run_index = i;
+    R.position = Positions[i];
+    R.length = Lengths[i];
+    R.item = Items[i];
+    return(R);
+};
+
+template<class T_ITEM, class T_COUNT>
+typename SequenceRuns<T_ITEM, T_COUNT>::index_list_type
+SequenceRuns<T_ITEM, T_COUNT>::get_item_runs(const T_ITEM& item) const
+{
+    _trace("get_item_runs ( item )");
+    item_runs_type_CI p = ItemRuns.find(item);
+    if (p == ItemRuns.end()) return(index_list_type());
+    return(index_list_type(p->second));
+};
+
+template<class T_ITEM, class T_COUNT>
+typename SequenceRuns<T_ITEM, T_COUNT>::run_list_type
+SequenceRuns<T_ITEM, T_COUNT>::get_item_lengths(const T_ITEM& item) const
+{
+    _trace("get_item_lengths ( item )");
+    item_runs_type_CI p = ItemRuns.find(item);
+    if (p == ItemRuns.end() || p->second.empty()) return(run_list_type());
+    return(run_list_type(&Lengths[0], &p->second[0], p->second.size()));
 };
 
 template<class T_ITEM, class T_COUNT>
@@ -254,8 +571,11 @@ SequenceRuns<T_ITEM, T_COUNT>::build_map()
 {
     _trace("build_map ( )");
     Map.clear();
-    for (long i = 0; i < num_runs; ++i) {
-        Map[Runs[i].item].push_back( Runs[i].length );
+    for (item_runs_type_CI p = ItemRuns.begin(); p != ItemRuns.end(); ++p) {
+        std::vector<T_COUNT>& L = Map[p->first];
+        L.reserve(p->second.size());
+        for (size_t i = 0; i < p->second.size(); ++i)
+            L.push_back(Lengths[p->second[i]]);
     }
 };
 
@@ -264,6 +584,7 @@ const typename SequenceRuns<T_ITEM, T_COUNT>::map_type&
 SequenceRuns<T_ITEM, T_COUNT>::get_map()
 {
     _trace("get_map ( )");
+    build_map();
     return(Map);
 };
 
@@ -275,7 +596,7 @@ SequenceRuns<T_ITEM, T_COUNT>::print_runs(std::ostream& os, const int width) con
     os << "Runs: " << std::endl;
     int ww = 0;
     for (long i = 0; i < num_runs; ++i) {
-        os << Runs[i];
+        os << get_run(i);
         //os << prefix << i << midfix << "( " << Runs[i].item
         //    << " : " << Runs[i].length << " )" << infix;
         if (ww == (width - 1)) { os << std::endl; } else { os << "\t"; }
@@ -299,7 +620,7 @@ SequenceRuns<T_ITEM, T_COUNT>::print_runs_table(std::ostream& os,
             << "\t" << "run_item" << std::endl;
     }
     for (long i = 0; i < num_runs; ++i) {
-        Runs[i].print_table(os);
+        get_run(i).print_table(os);
     }
 };
 
@@ -311,9 +632,9 @@ SequenceRuns<T_ITEM, T_COUNT>::print_unique_items(std::ostream& os,
     _trace("print_unique_items ( os, width )");
     os << "Unique items: ";
     int ww = 0;
-    unique_item_type_CI p;
-    for (p = unique_items.begin(); p != unique_items.end(); ++p) {
-        os << p->first << ": " << p->second;
+    item_runs_type_CI p;
+    for (p = ItemRuns.begin(); p != ItemRuns.end(); ++p) {
+        os << p->first << ": " << p->second.size();
         if (ww == (width - 1)) { os << std::endl; } else { os << ", "; }
         ww = (ww + 1) % width;
     }
@@ -333,9 +654,9 @@ SequenceRuns<T_ITEM, T_COUNT>::print_unique_items_table(std::ostream& os,
         os << "=================================" << std::endl;
         os << "unique_item" << "\t" << "runs_count" << std::endl;
     }
-    unique_item_type_CI p;
-    for (p = unique_items.begin(); p != unique_items.end(); ++p) {
-        os << p->first << "\t" << p->second << std::endl;
+    item_runs_type_CI p;
+    for (p = ItemRuns.begin(); p != ItemRuns.end(); ++p) {
+        os << p->first << "\t" << p->second.size() << std::endl;
     }
 };
 
@@ -362,40 +683,21 @@ SequenceRuns<T_ITEM, T_COUNT>::print_table(std::ostream& os,
     print_map_table(os, header); 
 };
 
-template<class T_ITEM, class T_COUNT>
-const typename SequenceRuns<T_ITEM, T_COUNT>::item_list_type
-SequenceRuns<T_ITEM, T_COUNT>::get_item_list() const
-{
-    _trace("get_item_list ( )");
-    item_list_type lst( num_runs );
-    for (long i = 0; i < num_runs; ++i) { lst[i] = Runs[i].item; }
-    return(lst);
-};
-
-template<class T_ITEM, class T_COUNT>
-const typename SequenceRuns<T_ITEM, T_COUNT>::run_list_type
-SequenceRuns<T_ITEM, T_COUNT>::get_run_list() const
-{
-    _trace("get_run_list ( )");
-    run_list_type lst( num_runs );
-    for (long i = 0; i < num_runs; ++i) { lst[i] = Runs[i].length; }
-    return(lst);
-};
-
 template<class T_ITEM, class T_COUNT>
 void 
 SequenceRuns<T_ITEM, T_COUNT>::print_map(std::ostream& os) const
 {
     _trace("print_map ( os )");
-    for (map_type_CI p = Map.begin(); p != Map.end(); ++p) {
+    for (item_runs_type_CI p = ItemRuns.begin(); p != ItemRuns.end(); ++p) {
         os << p->first << ": ";
         if (p->second.size() == 0) {
             os << "empty runs vector" << std::endl;
             continue;
         }
-        os << p->second[0];
-        for (long i = 1; i < p->second.size(); ++i) 
-            { os << " " << p->second[i]; }
+        const run_list_type L = get_item_lengths(p->first);
+        os << L[0];
+        for (size_t i = 1; i < L.size(); ++i) 
+            { os << " " << L[i]; }
         os << std::endl;
     }
     //os << "__END" << std::endl;
@@ -414,13 +716,14 @@ SequenceRuns<T_ITEM, T_COUNT>::print_map_table(std::ostream& os,
         os << "run_map_item" << "\t" << "run_map_index" << "\t"
             << "run_length" << std::endl;
     }
-    for (map_type_CI p = Map.begin(); p != Map.end(); ++p) {
+    for (item_runs_type_CI p = ItemRuns.begin(); p != ItemRuns.end(); ++p) {
         if (p->second.size() == 0) {
             os << p->first << "\t" << "NA" << "\t" << "NA" << std::endl;
             continue;
         }
-        for (long i = 0; i < p->second.size(); ++i) {
-            os << p->first << "\t" << i << "\t" << p->second[i] 
+        const run_list_type L = get_item_lengths(p->first);
+        for (size_t i = 0; i < L.size(); ++i) {
+            os << p->first << "\t" << i << "\t" << L[i] 
                 << std::endl;
         }
     }
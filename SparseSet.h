@@ -0,0 +1,219 @@
+#ifndef SPARSESET_H
+#define SPARSESET_H
+
+#include <vector>
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+
+/*! @class SparseSet
+
+    @brief Sorted set of positions, for sequences in which few sites are
+           set.
+
+    The positions are held in order in a list of chunks, each a sorted
+    std::vector of at most max_chunk positions; chunks are kept non-empty
+    and in order, so the last position of each chunk is a search key for
+    the chunk.  Lookups are a binary search over chunks then a binary
+    search within one, so touch only a couple of cache lines of positions.
+    Inserting or erasing a single position shifts at most max_chunk
+    positions, splitting a full chunk or dropping an empty one.  Erasing a
+    range drops the chunks wholly inside it and trims the two at its ends.
+    The number of positions is kept, so size() is O(1).
+
+    Ranges are half-open, [first, last).
+ */
+template<class T>
+class SparseSet {
+
+    public:
+
+        enum { max_chunk = 512 };
+
+        typedef std::vector<T>              chunk_type;
+        typedef std::vector<chunk_type>     chunks_type;
+
+    private:
+
+        chunks_type     Chunks;
+        size_t          _size;
+
+        //! index of the first chunk whose last position is >= x, or
+        //! Chunks.size() if there is none
+        size_t
+        find_chunk(const T x) const
+        {
+            size_t lo = 0, hi = Chunks.size();
+            while (lo < hi) {
+                size_t mid = lo + (hi - lo) / 2;
+                if (Chunks[mid].back() < x) lo = mid + 1;
+                else hi = mid;
+            }
+            return(lo);
+        };
+
+        void
+        split_chunk(const size_t c)
+        {
+            chunk_type& C = Chunks[c];
+            chunk_type upper(C.begin() + C.size() / 2, C.end());
+            C.resize(C.size() / 2);
+            Chunks.insert(Chunks.begin() + c + 1, chunk_type());
+            Chunks[c + 1].swap(upper);
+        };
+
+    public:
+
+        SparseSet() : _size(0) { };
+
+        size_t    size() const   { return(_size); };
+        bool      empty() const  { return(_size == 0); };
+        void      clear()        { Chunks.clear(); _size = 0; };
+
+        bool
+        contains(const T x) const
+        {
+            size_t c = find_chunk(x);
+            if (c == Chunks.size()) return(false);
+            return(std::binary_search(Chunks[c].begin(), Chunks[c].end(), x));
+        };
+
+        //! Add x, returning false if it was already present
+        bool
+        insert(const T x)
+        {
+            size_t c = find_chunk(x);
+            if (c == Chunks.size()) {
+                // beyond every position, append to the last chunk
+                if (c == 0 || Chunks[c - 1].size() >= max_chunk)
+                    Chunks.push_back(chunk_type());
+                else
+                    --c;
+                Chunks.back().push_back(x);
+                c = Chunks.size() - 1;
+            } else {
+                chunk_type& C = Chunks[c];
+                typename chunk_type::iterator p = std::lower_bound(C.begin(),
+                                                                   C.end(), x);
+                if (*p == x) return(false);
+                C.insert(p, x);
+            }
+            ++_size;
+            if (Chunks[c].size() > max_chunk) split_chunk(c);
+            return(true);
+        };
+
+        //! Remove x, returning false if it was not present
+        bool
+        erase(const T x)
+        {
+            size_t c = find_chunk(x);
+            if (c == Chunks.size()) return(false);
+            chunk_type& C = Chunks[c];
+            typename chunk_type::iterator p = std::lower_bound(C.begin(),
+                                                               C.end(), x);
+            if (*p != x) return(false);
+            C.erase(p);
+            --_size;
+            if (C.empty()) Chunks.erase(Chunks.begin() + c);
+            return(true);
+        };
+
+        //! Remove every position in [first, last)
+        void
+        erase_range(const T first, const T last)
+        {
+            if (! (first < last)) return;
+            size_t c = find_chunk(first);
+            size_t c_end = c;
+            // chunks from c up to c_end have positions in [first, last)
+            while (c_end < Chunks.size() && Chunks[c_end].front() < last)
+                ++c_end;
+            size_t drop_first = c_end, drop_last = c_end;
+            for (size_t i = c; i < c_end; ++i) {
+                chunk_type& C = Chunks[i];
+                typename chunk_type::iterator lo = std::lower_bound(C.begin(),
+                                                                    C.end(), first);
+                typename chunk_type::iterator hi = std::lower_bound(lo, C.end(),
+                                                                    last);
+                _size -= (hi - lo);
+                if (lo == C.begin() && hi == C.end()) {
+                    if (drop_first == c_end) drop_first = i;
+                    drop_last = i + 1;
+                } else {
+                    C.erase(lo, hi);
+                }
+            }
+            // chunks emptied entirely are contiguous
+            Chunks.erase(Chunks.begin() + drop_first, Chunks.begin() + drop_last);
+        };
+
+        //! Add every position in [first, last)
+        void
+        insert_range(const T first, const T last)
+        {
+            for (T x = first; x < last; ++x) insert(x);
+        };
+
+        //! Number of positions in [first, last)
+        size_t
+        count(const T first, const T last) const
+        {
+            size_t n = 0;
+            for (size_t c = find_chunk(first); c < Chunks.size() &&
+                 Chunks[c].front() < last; ++c) {
+                const chunk_type& C = Chunks[c];
+                n += std::lower_bound(C.begin(), C.end(), last) -
+                     std::lower_bound(C.begin(), C.end(), first);
+            }
+            return(n);
+        };
+
+        //! Call f(x) for each position x in order
+        template<class F>
+        void
+        for_each(F f) const
+        {
+            for (size_t c = 0; c < Chunks.size(); ++c)
+                for (size_t i = 0; i < Chunks[c].size(); ++i) f(Chunks[c][i]);
+        };
+
+        //! Call f(x) for each position x in [first, last) in order
+        template<class F>
+        void
+        for_each(const T first, const T last, F f) const
+        {
+            for (size_t c = find_chunk(first); c < Chunks.size() &&
+                 Chunks[c].front() < last; ++c) {
+                const chunk_type& C = Chunks[c];
+                typename chunk_type::const_iterator p = std::lower_bound(C.begin(),
+                                                                         C.end(), first);
+                for ( ; p != C.end() && *p < last; ++p) f(*p);
+            }
+        };
+
+        //! All positions, in order
+        void
+        get_positions(std::vector<T>& Vec) const
+        {
+            Vec.clear();
+            Vec.reserve(_size);
+            for (size_t c = 0; c < Chunks.size(); ++c)
+                Vec.insert(Vec.end(), Chunks[c].begin(), Chunks[c].end());
+        };
+
+        //! Reset to the positions in Vec, which must be sorted and unique
+        void
+        assign(const std::vector<T>& Vec)
+        {
+            clear();
+            for (size_t i = 0; i < Vec.size(); i += max_chunk / 2) {
+                size_t n = std::min(size_t(max_chunk / 2), Vec.size() - i);
+                Chunks.push_back(chunk_type(Vec.begin() + i, Vec.begin() + i + n));
+            }
+            _size = Vec.size();
+        };
+};
+
+#endif // SPARSESET_H
+
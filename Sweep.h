@@ -0,0 +1,246 @@
+#ifndef SWEEP_H
+#define SWEEP_H
+
+#include <vector>
+#include <string>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <iomanip>
+#include <cstdlib>
+#include <climits>
+#include "Chromosome.h"
+#include "WorkStealing.h"
+
+/*! @class Sweep
+
+    @brief Run replicate simulations over a grid of parameters in parallel,
+           collecting a summary of each into one table.
+
+    The grid is read from a file of lines 'name value [value ...]', one per
+    parameter, with '#' comments; each parameter not given keeps the
+    default shown:
+
+        nbp         1000      chromosome length
+        mu          1e-7      mutation rate per site per tick
+        c           1e-6      break rate per site per tick
+        tract_p     0.01      geometric tract length parameter
+        het         0.4       initial heterozygosity
+        breaks      40        stop each run after this many breaks, 0 for
+                              no limit
+        ticks       0         stop each run after this many ticks, 0 for
+                              no limit; one of breaks or ticks must be set
+        replicates  8         replicates of every grid point
+        first_seed  0         seed of the first task
+
+    Every combination of the values of nbp, mu, c, tract_p and het is a grid
+    point, and each has replicates tasks.  Task i is replicate
+    (i % replicates) of grid point (i / replicates), run on a fresh
+    Chromosome with set_seed(first_seed + i), so every task draws from its
+    own streams and can be rerun on its own.  Run times vary widely across
+    the grid, so tasks are scheduled with WorkStealing.  The table holds one
+    row per task, in task order whatever the number of threads.
+ */
+class Sweep {
+
+    public:
+
+        //! parameters of one grid point
+        struct Point {
+            long    nbp;
+            double  mu, c, tract_p, het;
+        };
+
+        //! summary of one task
+        struct Result {
+            long    ticks, mutations, breaks, heterozygous, hom_runs;
+            double  hom_mean;
+            Result() : ticks(0), mutations(0), breaks(0), heterozygous(0),
+                       hom_runs(0), hom_mean(0.0) { };
+        };
+
+    private:
+
+        std::vector<long>     NBP;
+        std::vector<double>   Mu, C, TractP, Het;
+        long                  _breaks;
+        long                  _ticks;
+        long                  _replicates;
+        unsigned long         _first_seed;
+        std::vector<Point>    Points;
+        std::vector<Result>   Results;
+        long                  _num_steals;
+
+        template<class T>
+        static void
+        read_values(std::istringstream& iss, std::vector<T>& Vec)
+        {
+            Vec.clear();
+            T v;
+            while (iss >> v) Vec.push_back(v);
+        };
+
+        void
+        expand()
+        {
+            Points.clear();
+            for (size_t a = 0; a < NBP.size(); ++a)
+            for (size_t b = 0; b < Mu.size(); ++b)
+            for (size_t d = 0; d < C.size(); ++d)
+            for (size_t e = 0; e < TractP.size(); ++e)
+            for (size_t g = 0; g < Het.size(); ++g) {
+                Point p = { NBP[a], Mu[b], C[d], TractP[e], Het[g] };
+                Points.push_back(p);
+            }
+        };
+
+        Result
+        run_task(const long task) const
+        {
+            const Point& p = Points[task / _replicates];
+            Chromosome Chr;
+            Chr.set_seed(_first_seed + task);
+            Chr.init(p.nbp);
+            Chr.set_debug_repair(0);
+            Chr.set_mu(p.mu);
+            Chr.set_c(p.c);
+            Chr.set_tract_geometric(p.tract_p);
+            Chr.set_heterozygosity(p.het);
+            const Chromosome::Tick_t end = _ticks ? _ticks : LONG_MAX;
+            long num_breaks = _breaks ? _breaks : -1;
+            while (num_breaks != 0 && Chr.get_tick() < end) {
+                // step() jumps to the next event, which may lie past end
+                if (Chr.next_event_tick() > end) { Chr.run(end - Chr.get_tick()); break; }
+                Chr.step();
+                if (Chr.get_did_break()) --num_breaks;
+                Chr.repair1();
+            }
+            Result r;
+            r.ticks = Chr.get_tick();
+            r.mutations = Chr.number_mutations();
+            r.breaks = Chr.number_dsbreaks();
+            r.heterozygous = Chr.number_heterozygous();
+            Chr.set_track_runs(true);
+            Chromosome::run_map_type::stats_type_CI s =
+                Chr.get_runs().get_stats().find(Chromosome::HOMZ);
+            if (s != Chr.get_runs().get_stats().end() && s->second.num_runs > 0) {
+                r.hom_runs = s->second.num_runs;
+                r.hom_mean = s->second.mean();
+            }
+            return(r);
+        };
+
+        struct TaskRunner {
+            Sweep& S;
+            TaskRunner(Sweep& s) : S(s) { };
+            void operator()(const long task, unsigned)
+            { S.Results[task] = S.run_task(task); };
+        };
+
+    public:
+
+        Sweep()
+            : _breaks(40), _ticks(0), _replicates(8), _first_seed(0),
+              _num_steals(0)
+        {
+            NBP.assign(1, 1000);
+            Mu.assign(1, 0.0000001);
+            C.assign(1, 0.000001);
+            TractP.assign(1, 0.01);
+            Het.assign(1, 0.4);
+            expand();
+        };
+
+        //! Read the grid from a file, see above
+        void
+        load_grid(const std::string& filename)
+        {
+            std::ifstream ifs(filename.c_str());
+            if (! ifs) {
+                std::cerr << "Sweep::load_grid : cannot open " << filename << std::endl;
+                exit(1);
+            }
+            std::string line;
+            long line_num = 0;
+            while (std::getline(ifs, line)) {
+                ++line_num;
+                std::istringstream iss(line);
+                std::string name;
+                if (! (iss >> name) || name[0] == '#') continue;
+                size_t n = 0;
+                if (name == "nbp")             { read_values(iss, NBP); n = NBP.size(); }
+                else if (name == "mu")         { read_values(iss, Mu); n = Mu.size(); }
+                else if (name == "c")          { read_values(iss, C); n = C.size(); }
+                else if (name == "tract_p")    { read_values(iss, TractP); n = TractP.size(); }
+                else if (name == "het")        { read_values(iss, Het); n = Het.size(); }
+                else if (name == "breaks")     { n = (iss >> _breaks) ? 1 : 0; }
+                else if (name == "ticks")      { n = (iss >> _ticks) ? 1 : 0; }
+                else if (name == "replicates") { n = (iss >> _replicates) ? 1 : 0; }
+                else if (name == "first_seed") { n = (iss >> _first_seed) ? 1 : 0; }
+                else {
+                    std::cerr << "Sweep::load_grid : " << filename << " line "
+                        << line_num << " : unknown parameter " << name << std::endl;
+                    exit(1);
+                }
+                if (n == 0) {
+                    std::cerr << "Sweep::load_grid : " << filename << " line "
+                        << line_num << " : no values for " << name << std::endl;
+                    exit(1);
+                }
+            }
+            if ((_breaks <= 0 && _ticks <= 0) || _replicates <= 0) {
+                std::cerr << "Sweep::load_grid : " << filename
+                    << " : need replicates > 0 and breaks or ticks > 0" << std::endl;
+                exit(1);
+            }
+            expand();
+            if (_first_seed + num_tasks() > Chromosome::max_seed()) {
+                std::cerr << "Sweep::load_grid : seeds must be less than "
+                    << Chromosome::max_seed() << std::endl;
+                exit(1);
+            }
+        };
+
+        long    num_points() const  { return(Points.size()); };
+        long    num_tasks() const   { return(Points.size() * _replicates); };
+        //! Tasks stolen by idle threads in the last run()
+        long    num_steals() const  { return(_num_steals); };
+
+        /*! Run every task
+
+            @param nt   number of threads, 0 for the number of hardware threads
+         */
+        void
+        run(const unsigned nt = 0)
+        {
+            Results.assign(num_tasks(), Result());
+            WorkStealing W;
+            W.run(num_tasks(), nt, TaskRunner(*this));
+            _num_steals = W.num_steals();
+        };
+
+        const std::vector<Result>&  results() const { return(Results); };
+
+        //! Print one row per task with its grid point and results
+        void
+        print_table(std::ostream& os = std::cout, bool header = true) const
+        {
+            if (header)
+                os << "task\tpoint\treplicate\tseed\tnbp\tmu\tc\ttract_p\thet\t"
+                    "ticks\tmutations\tbreaks\theterozygous\thom_runs\thom_mean"
+                    << std::endl;
+            for (size_t i = 0; i < Results.size(); ++i) {
+                const Point& p = Points[i / _replicates];
+                const Result& r = Results[i];
+                os << i << "\t" << i / _replicates << "\t" << i % _replicates
+                    << "\t" << _first_seed + i << "\t" << p.nbp << "\t" << p.mu
+                    << "\t" << p.c << "\t" << p.tract_p << "\t" << p.het
+                    << "\t" << r.ticks << "\t" << r.mutations << "\t" << r.breaks
+                    << "\t" << r.heterozygous << "\t" << r.hom_runs
+                    << "\t" << r.hom_mean << std::endl;
+            }
+        };
+};
+
+#endif // SWEEP_H
+
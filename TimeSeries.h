@@ -0,0 +1,274 @@
+#ifndef TIMESERIES_H
+#define TIMESERIES_H
+
+#include <vector>
+#include <string>
+#include <thread>
+#include <functional>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <stdint.h>
+#include <unistd.h>
+#include "Checkpoint.h"
+
+/*! @class TimeSeries
+
+    @brief Periodic samples of chromosome statistics, streamed to a file.
+
+    A sample is taken every interval ticks (EVERY_TICKS) or every interval
+    events, mutations plus breaks (EVERY_EVENTS); see Chromosome::run().
+    Samples are recorded into a buffer of capacity samples allocated up
+    front.  When the buffer fills it is swapped with a second buffer of the
+    same size, which a writer thread appends to the file while the
+    simulation carries on recording into the first.  The writer for one
+    buffer is joined before the next is handed off, so at most one write is
+    ever in flight.  close() writes whatever is left.
+
+    The file is either tab-separated text (FORMAT_TSV) with a header line
+    naming the columns of Sample, or (FORMAT_BINARY) raw Sample records in
+    native byte order, each the fields of Sample in turn with no padding
+    between them: 8-byte integers for tick, events, het_sites and the
+    numbers of runs, 8-byte doubles otherwise.
+ */
+class TimeSeries {
+
+    public:
+
+        enum interval_type { EVERY_TICKS = 0, EVERY_EVENTS = 1 };
+        enum format_type { FORMAT_TSV = 0, FORMAT_BINARY = 1 };
+
+        //! statistics at one sample point
+        struct Sample {
+            int64_t     tick;
+            int64_t     events;      // mutations plus breaks so far
+            double      het;         // fraction of sites heterozygous
+            int64_t     het_sites;
+            int64_t     hom_runs;    // runs of homozygous sites
+            double      hom_mean;    // mean length of homozygous runs
+            double      hom_var;
+            int64_t     het_runs;    // runs of heterozygous sites
+            double      het_mean;
+            double      het_var;
+        };
+
+    private:
+
+        interval_type           _interval_type;
+        long                    _interval;
+        format_type             _format;
+        size_t                  _capacity;
+        std::string             _filename;
+        long                    _count;     // samples recorded
+        std::vector<Sample>     Buffer;     // being recorded into
+        std::vector<Sample>     Pending;    // being written by Writer
+        std::thread             Writer;
+        bool                    _open;
+        bool                    _resume;    // load_state() found it open
+        std::ofstream           _file;      // touched only by Writer when running
+        uint64_t                _file_size; // of the file before Pending
+
+        TimeSeries(const TimeSeries&);             // not copyable, owns a file
+        TimeSeries& operator=(const TimeSeries&);
+
+        void
+        write_samples(const std::vector<Sample>& S)
+        {
+            if (_format == FORMAT_BINARY) {
+                for (size_t i = 0; i < S.size(); ++i) {
+                    const Sample& s = S[i];
+                    Checkpoint::write(_file, s.tick);
+                    Checkpoint::write(_file, s.events);
+                    Checkpoint::write(_file, s.het);
+                    Checkpoint::write(_file, s.het_sites);
+                    Checkpoint::write(_file, s.hom_runs);
+                    Checkpoint::write(_file, s.hom_mean);
+                    Checkpoint::write(_file, s.hom_var);
+                    Checkpoint::write(_file, s.het_runs);
+                    Checkpoint::write(_file, s.het_mean);
+                    Checkpoint::write(_file, s.het_var);
+                }
+            } else {
+                for (size_t i = 0; i < S.size(); ++i) {
+                    const Sample& s = S[i];
+                    _file << s.tick << "\t" << s.events << "\t"
+                        << s.het << "\t" << s.het_sites << "\t"
+                        << s.hom_runs << "\t" << s.hom_mean << "\t"
+                        << s.hom_var << "\t" << s.het_runs << "\t"
+                        << s.het_mean << "\t" << s.het_var << "\n";
+                }
+            }
+            _file.flush();
+            if (! _file) {
+                std::cerr << "TimeSeries : error writing " << _filename << std::endl;
+            }
+        };
+
+        void
+        join()
+        {
+            if (Writer.joinable()) Writer.join();
+        };
+
+        // hand the buffer to the writer thread and start a fresh one
+        void
+        hand_off()
+        {
+            join();
+            Pending.clear();  // written
+            if (_open) _file_size = _file.tellp();
+            if (Buffer.empty() || ! _open) return;
+            Pending.swap(Buffer);
+            Buffer.clear();
+            Writer = std::thread(&TimeSeries::write_samples, this,
+                                 std::cref(Pending));
+        };
+
+        // when appending, samples past _file_size are cut off first
+        bool
+        open_file(const bool append)
+        {
+            if (append && truncate(_filename.c_str(), _file_size) != 0) {
+                std::cerr << "TimeSeries : cannot truncate " << _filename << std::endl;
+                return(false);
+            }
+            _file.open(_filename.c_str(), std::ios::binary |
+                       (append ? std::ios::app | std::ios::ate : std::ios::trunc));
+            if (! _file) {
+                std::cerr << "TimeSeries : cannot open " << _filename << std::endl;
+                return(false);
+            }
+            _open = true;
+            _file << std::setprecision(10);
+            if (! append && _format == FORMAT_TSV) {
+                _file << "tick\tevents\thet\thet_sites\thom_runs\thom_mean\t"
+                    "hom_var\thet_runs\thet_mean\thet_var\n";
+            }
+            _file_size = _file.tellp();
+            return(true);
+        };
+
+    public:
+
+        TimeSeries()
+            : _interval_type(EVERY_TICKS), _interval(0), _format(FORMAT_TSV),
+              _capacity(0), _count(0), _open(false), _resume(false),
+              _file_size(0)
+        { /* empty */ };
+
+        ~TimeSeries() { close(); };
+
+        /*! Start a time series, truncating the file
+
+            @param filename   file to write
+            @param t          sample every interval ticks or events
+            @param interval   ticks or events between samples
+            @param f          FORMAT_TSV or FORMAT_BINARY
+            @param capacity   samples held per buffer
+         */
+        bool
+        open(const std::string& filename, const interval_type t,
+             const long interval, const format_type f = FORMAT_TSV,
+             const size_t capacity = 4096)
+        {
+            close();
+            if (interval <= 0 || capacity == 0) {
+                std::cerr << "TimeSeries::open : interval and capacity must be > 0"
+                    << std::endl;
+                return(false);
+            }
+            _filename = filename;
+            _interval_type = t;
+            _interval = interval;
+            _format = f;
+            _capacity = capacity;
+            _count = 0;
+            Buffer.reserve(_capacity);
+            Pending.reserve(_capacity);
+            return(open_file(false));
+        };
+
+        //! Write all samples recorded and close the file
+        void
+        close()
+        {
+            hand_off();
+            join();
+            Pending.clear();
+            if (_open) _file.close();
+            _open = false;
+            _resume = false;
+        };
+
+        bool            is_open() const           { return(_open); };
+        interval_type   get_interval_type() const { return(_interval_type); };
+        long            get_interval() const      { return(_interval); };
+        //! Number of samples recorded
+        long            count() const             { return(_count); };
+
+        void
+        record(const Sample& s)
+        {
+            if (! _open) return;
+            Buffer.push_back(s);
+            ++_count;
+            if (Buffer.size() >= _capacity) hand_off();
+        };
+
+        // settings and samples not yet known to be in the file, for
+        // checkpoints; those being written may or may not reach it, so the
+        // file is cut back by resume() after load_state() to its length
+        // before them and reopened for appending, and they are written
+        // again from the buffer
+        void
+        save_state(std::ostream& os) const
+        {
+            Checkpoint::write(os, _open);
+            Checkpoint::write(os, int(_interval_type));
+            Checkpoint::write(os, _interval);
+            Checkpoint::write(os, int(_format));
+            Checkpoint::write(os, static_cast<uint64_t>(_capacity));
+            Checkpoint::write(os, _count);
+            Checkpoint::write(os, _file_size);
+            Checkpoint::write(os, static_cast<uint64_t>(_filename.size()));
+            os.write(_filename.data(), _filename.size());
+            std::vector<Sample> Unwritten(Pending);
+            Unwritten.insert(Unwritten.end(), Buffer.begin(), Buffer.end());
+            Checkpoint::write_vector(os, Unwritten);
+        };
+
+        bool
+        load_state(std::istream& is)
+        {
+            close();
+            bool was_open;
+            int t, f;
+            uint64_t cap, len;
+            if (! (Checkpoint::read(is, was_open) && Checkpoint::read(is, t) &&
+                   Checkpoint::read(is, _interval) && Checkpoint::read(is, f) &&
+                   Checkpoint::read(is, cap) && Checkpoint::read(is, _count) &&
+                   Checkpoint::read(is, _file_size) &&
+                   Checkpoint::read(is, len))) return(false);
+            _interval_type = interval_type(t);
+            _format = format_type(f);
+            _capacity = cap;
+            _filename.resize(len);
+            if (len && ! is.read(&_filename[0], len)) return(false);
+            if (! Checkpoint::read_vector(is, Buffer)) return(false);
+            Buffer.reserve(_capacity);
+            Pending.reserve(_capacity);
+            _resume = was_open;
+            return(true);
+        };
+
+        //! Reopen the file of a series restored by load_state()
+        void
+        resume()
+        {
+            if (_resume) open_file(true);
+            _resume = false;
+        };
+};
+
+#endif // TIMESERIES_H
+
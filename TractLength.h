@@ -0,0 +1,208 @@
+#ifndef TRACTLENGTH_H
+#define TRACTLENGTH_H
+
+// class TractLength
+//
+// Draws gene conversion tract lengths for Chromosome::repair1() from one of
+// several distributions:
+//
+//   GEOMETRIC  number of failures before the first success with success
+//              probability p, the same as RandGeometric
+//   MIXTURE    with probability w a GEOMETRIC length with p1, otherwise a
+//              GEOMETRIC length with p2, e.g. for a mixture of short and long
+//              tracts
+//   EMPIRICAL  a table of lengths and their relative weights, for example an
+//              observed tract length distribution such as that of Hilliker et
+//              al. 1994 Genetics 137:1019-1026, sampled in O(1) with an alias
+//              table
+//
+// Empirical tables are read from a file of whitespace-separated length and
+// weight pairs, one per line.  Blank lines and lines beginning with '#' are
+// skipped.
+
+#include <cmath>
+#include <cassert>
+#include <cstdlib>
+#include <vector>
+#include <string>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include "RandUniformPool.h"
+#include "AliasTable.h"
+#include "Checkpoint.h"
+
+class TractLength {
+
+    public:
+
+        enum model_type { GEOMETRIC = 0, MIXTURE = 1, EMPIRICAL = 2 };
+
+    private:
+
+        model_type          model;
+        RandUniformPool     unif;
+        double              weight1;  // MIXTURE, probability of component 1
+        double              prob1, prob2;
+        double              log_1_minus_prob1, log_1_minus_prob2;
+        std::vector<long>   Lengths;  // EMPIRICAL
+        AliasTable          Table;
+
+        long
+        geometric(double prob, double log_1_minus_prob)
+        {
+            if (prob == 1.0) { return(0); }
+            return(static_cast<long>(log(unif.draw()) / log_1_minus_prob));
+        };
+
+        static void
+        check_prob(double p)
+        {
+            if (p <= 0.0 || p > 1.0) {
+                std::cerr << "TractLength : geometric p must be in (0, 1]" 
+                    << std::endl;
+                exit(1);
+            }
+        };
+
+    public:
+
+        TractLength(const double p = (1.0 - 0.9))
+            : model(GEOMETRIC), weight1(1.0), prob1(p), prob2(p),
+              log_1_minus_prob1(0.0), log_1_minus_prob2(0.0)
+        { set_geometric(p); };
+
+        model_type  get_model() const  { return(model); };
+
+        void        init_stream(const unsigned long stream)
+        { unif.init_stream(stream); };
+
+        void
+        set_geometric(const double p)
+        {
+            check_prob(p);
+            model = GEOMETRIC;
+            prob1 = p;
+            if (prob1 != 1.0) { log_1_minus_prob1 = log(1.0 - prob1); }
+        };
+
+        void
+        set_mixture(const double w, const double p1, const double p2)
+        {
+            if (w < 0.0 || w > 1.0) {
+                std::cerr << "TractLength::set_mixture : w must be in [0, 1]" 
+                    << std::endl;
+                exit(1);
+            }
+            check_prob(p1);
+            check_prob(p2);
+            model = MIXTURE;
+            weight1 = w;
+            prob1 = p1;
+            prob2 = p2;
+            if (prob1 != 1.0) { log_1_minus_prob1 = log(1.0 - prob1); }
+            if (prob2 != 1.0) { log_1_minus_prob2 = log(1.0 - prob2); }
+        };
+
+        void
+        set_empirical(const std::vector<long>& lengths,
+                      const std::vector<double>& weights)
+        {
+            if (lengths.size() != weights.size() || lengths.empty()) {
+                std::cerr << "TractLength::set_empirical : need one weight "
+                    << "per length" << std::endl;
+                exit(1);
+            }
+            for (size_t i = 0; i < lengths.size(); ++i) {
+                if (lengths[i] < 0) {
+                    std::cerr << "TractLength::set_empirical : negative length"
+                        << std::endl;
+                    exit(1);
+                }
+            }
+            model = EMPIRICAL;
+            Lengths = lengths;
+            Table.build(weights);
+        };
+
+        void
+        load_empirical(const std::string& filename)
+        {
+            std::ifstream ifs(filename.c_str());
+            if (! ifs) {
+                std::cerr << "TractLength::load_empirical : cannot open " 
+                    << filename << std::endl;
+                exit(1);
+            }
+            std::vector<long> lengths;
+            std::vector<double> weights;
+            std::string line;
+            long line_num = 0;
+            while (std::getline(ifs, line)) {
+                ++line_num;
+                std::istringstream iss(line);
+                std::string first;
+                if (! (iss >> first) || first[0] == '#') continue;
+                std::istringstream fss(first);
+                long length;
+                double weight;
+                if (! (fss >> length) || ! (iss >> weight)) {
+                    std::cerr << "TractLength::load_empirical : " << filename
+                        << " line " << line_num << " is not 'length weight'"
+                        << std::endl;
+                    exit(1);
+                }
+                lengths.push_back(length);
+                weights.push_back(weight);
+            }
+            set_empirical(lengths, weights);
+        };
+
+        // model, parameters and generator state, for checkpoints
+        void
+        save_state(std::ostream& os) const
+        {
+            Checkpoint::write(os, int(model));
+            unif.save_state(os);
+            Checkpoint::write(os, weight1);
+            Checkpoint::write(os, prob1);
+            Checkpoint::write(os, prob2);
+            Checkpoint::write(os, log_1_minus_prob1);
+            Checkpoint::write(os, log_1_minus_prob2);
+            Checkpoint::write_vector(os, Lengths);
+            if (model == EMPIRICAL) Table.save_state(os);
+        };
+
+        bool
+        load_state(std::istream& is)
+        {
+            int m;
+            if (! (Checkpoint::read(is, m) && unif.load_state(is) &&
+                   Checkpoint::read(is, weight1) && Checkpoint::read(is, prob1) &&
+                   Checkpoint::read(is, prob2) &&
+                   Checkpoint::read(is, log_1_minus_prob1) &&
+                   Checkpoint::read(is, log_1_minus_prob2) &&
+                   Checkpoint::read_vector(is, Lengths))) return(false);
+            model = model_type(m);
+            if (model == EMPIRICAL) return(Table.load_state(is));
+            return(true);
+        };
+
+        long
+        draw()
+        {
+            switch (model) {
+                case MIXTURE:
+                    if (unif.draw() < weight1) 
+                        return(geometric(prob1, log_1_minus_prob1));
+                    return(geometric(prob2, log_1_minus_prob2));
+                case EMPIRICAL:
+                    return(Lengths[Table.sample(unif.draw())]);
+                case GEOMETRIC:
+                default:
+                    return(geometric(prob1, log_1_minus_prob1));
+            }
+        };
+};
+
+#endif // TRACTLENGTH_H
@@ -4,24 +4,47 @@
 #include <vector>
 #include <string>
 #include <map>
+#include <utility>
+#include <algorithm>
+#include <thread>
+#include <cstddef>
 #include <cassert>
 #include <iostream>
+#include "VectorView.h"
 
+// Sum(), SumSquares(), Mean(), Var(), Min(), Max() and Summarize() of a
+// vector also take a VectorView, so values held elsewhere need not be
+// copied into a vector first.
 namespace VectorUtility {
 
     typedef long Scalar;
 
+    template<class T> class Moments;
+
     template<class T> inline const T        Max(const T& a, const T& b);
     template<class T> inline const T        Max(const std::vector<T>& Vec);
+    template<class T> inline const T        Max(const VectorView<T>& Vec);
     template<class T> inline const T        Abs(const T a);
     template<class T> inline const T        Min(const T& a, const T& b);
     template<class T> inline const T        Min(const std::vector<T>& Vec);
+    template<class T> inline const T        Min(const VectorView<T>& Vec);
     template<class T> inline const double   Sum(const std::vector<T>& Vec);
+    template<class T> inline const double   Sum(const VectorView<T>& Vec);
     template<class T> inline const double   SumSquares(const std::vector<T>& Vec);
+    template<class T> inline const double   SumSquares(const VectorView<T>& Vec);
     template<class T> inline const double   Mean(const std::vector<T>& Vec);
+    template<class T> inline const double   Mean(const VectorView<T>& Vec);
     template<class T> inline const double   Var(const std::vector<T>& Vec, 
                                                 bool sample = true);
+    template<class T> inline const double   Var(const VectorView<T>& Vec, 
+                                                bool sample = true);
     template<class T> inline const double   Var2(const std::vector<T>& Vec);
+    template<class T> inline const Moments<T>
+                                            Summarize(const std::vector<T>& Vec,
+                                                      unsigned nt = 1);
+    template<class T> inline const Moments<T>
+                                            Summarize(const VectorView<T>& Vec,
+                                                      unsigned nt = 1);
     template<class T> inline const bool     IsIn(const std::vector<T>& Vec, 
                                                 const T& val);
     template<class T> inline const std::vector<T>
@@ -64,12 +87,17 @@ namespace VectorUtility {
      */
     template<class T>
     inline const double
-    Mean(const std::vector<T>& Vec)
+    Mean(const VectorView<T>& Vec)
     {
         assert(Vec.size() > 0);
         return(Sum(Vec) / static_cast<double>(Vec.size()));
     }
 
+    template<class T>
+    inline const double
+    Mean(const std::vector<T>& Vec)
+    { return(Mean(VectorView<T>(Vec))); }
+
     /*! @brief Sum of values in vector of class T, returned as a double.
 
         @param  Vec     vector of class T.
@@ -77,15 +105,20 @@ namespace VectorUtility {
      */
     template<class T>
     inline const double
-    Sum(const std::vector<T>& Vec)
+    Sum(const VectorView<T>& Vec)
     {
         assert(Vec.size() > 0);
         double ans = static_cast<double>(Vec[0]);
-        for (long i = 1; i < Vec.size(); ++i) 
+        for (size_t i = 1; i < Vec.size(); ++i) 
             { ans += static_cast<double>(Vec[i]); }
         return(ans);
     }
 
+    template<class T>
+    inline const double
+    Sum(const std::vector<T>& Vec)
+    { return(Sum(VectorView<T>(Vec))); }
+
     /*! @brief Sum of squared values in vector of class T, returned as a 
                double.
 
@@ -94,17 +127,23 @@ namespace VectorUtility {
      */
     template<class T>
     inline const double
-    SumSquares(const std::vector<T>& Vec)
+    SumSquares(const VectorView<T>& Vec)
     {
         assert(Vec.size() > 0);
         double ans = (static_cast<double>(Vec[0]) * static_cast<double>(Vec[0]));
-        for (long i = 1; i < Vec.size(); ++i) { 
+        for (size_t i = 1; i < Vec.size(); ++i) { 
             ans += (static_cast<double>(Vec[i]) * static_cast<double>(Vec[i]));
         }
         return(ans);
     }
 
-    /*! @brief Variance of values in vector of class T, returned as a double.
+    template<class T>
+    inline const double
+    SumSquares(const std::vector<T>& Vec)
+    { return(SumSquares(VectorView<T>(Vec))); }
+
+    /*! @brief Variance of values in vector of class T, returned as a double,
+               from the Moments of Summarize().
 
         @param  Vec     vector of class T.
         @param  sample  bool, calculates sample variance (SS/(n-1)) if true,
@@ -113,17 +152,17 @@ namespace VectorUtility {
      */
     template<class T>
     inline const double
-    Var(const std::vector<T>& Vec, bool sample = true)
+    Var(const VectorView<T>& Vec, bool sample)
     {
-        long N = Vec.size();
-        assert(N > 0);
-        double sumsq = SumSquares(Vec);
-        double sum = Sum(Vec);
-        double ans = sumsq - ((sum * sum)/N);
-        ans /= (N - (sample ? 1 : 0));
-        return(ans);
+        assert(Vec.size() > 0);
+        return(Summarize(Vec).var(sample));
     }
 
+    template<class T>
+    inline const double
+    Var(const std::vector<T>& Vec, bool sample)
+    { return(Var(VectorView<T>(Vec), sample)); }
+
     /*! @brief Maximum value in vector of class T.
 
         @param  Vec     vector of class T.
@@ -131,7 +170,7 @@ namespace VectorUtility {
      */
     template<class T>
     inline const T
-    Max(const std::vector<T>& Vec)
+    Max(const VectorView<T>& Vec)
     {
         T ans;
         if (Vec.size() == 0) return(static_cast<T>(-9999999));
@@ -140,6 +179,11 @@ namespace VectorUtility {
         return(ans);
     }
 
+    template<class T>
+    inline const T
+    Max(const std::vector<T>& Vec)
+    { return(Max(VectorView<T>(Vec))); }
+
     /*! @brief Minimum value in vector of class T.
 
         @param  Vec     vector of class T.
@@ -147,7 +191,7 @@ namespace VectorUtility {
      */
     template<class T>
     inline const T
-    Min(const std::vector<T>& Vec) 
+    Min(const VectorView<T>& Vec) 
     {
         T ans;
         if (Vec.size() == 0) return(static_cast<T>(9999999));
@@ -156,6 +200,11 @@ namespace VectorUtility {
         return(ans);
     }
 
+    template<class T>
+    inline const T
+    Min(const std::vector<T>& Vec) 
+    { return(Min(VectorView<T>(Vec))); }
+
     /*! @brief absolute value for element of class T.
 
         @param  a       scalar of class T.
@@ -204,7 +253,8 @@ namespace VectorUtility {
     }
 
     /*! @brief Construct vector containing only unique values from vector 
-               of class T.
+               of class T, in order of first appearance.  O(n log n);
+               class T needs operator<.
 
         @param  Vec     vector of class T.
         @return         vector of class T, unique values from Vec
@@ -215,13 +265,188 @@ namespace VectorUtility {
     {
         std::vector<T> ans; // vector to hold the unique values
         assert(Vec.size() > 0);
-        ans.push_back(Vec[0]);
-        for (size_t i = 1; i < Vec.size(); ++i) {
-            if (! IsIn(ans, Vec[i])) { ans.push_back(Vec[i]); }
+        // sort (value, position) pairs, so the first of each group of
+        // equal values is its first appearance, then keep those in order
+        std::vector<std::pair<T, size_t> > P(Vec.size());
+        for (size_t i = 0; i < Vec.size(); ++i) P[i] = std::make_pair(Vec[i], i);
+        std::sort(P.begin(), P.end());
+        std::vector<char> first(Vec.size(), 0);
+        for (size_t i = 0; i < P.size(); ++i) {
+            if (i == 0 || P[i - 1].first < P[i].first) first[P[i].second] = 1;
+        }
+        for (size_t i = 0; i < Vec.size(); ++i) {
+            if (first[i]) { ans.push_back(Vec[i]); }
         }
         return(ans);
     }
 
+    /*! @class Moments
+
+        @brief Count, sum, minimum, maximum, mean and variance of values of
+               class T, gathered in one pass.
+
+        The mean and sum of squared deviations are kept as by Welford 1962
+        Technometrics 4:419-420, without the cancellation of the sum of
+        squares formula.  Moments of separate parts of a vector combine
+        exactly with merge(), as by Chan, Golub and LeVeque 1979, so parts
+        can be summarised apart, on different threads or a block at a time.
+     */
+    template<class T>
+    class Moments {
+        private:
+            long    _n;
+            double  _sum;
+            T       _min, _max;
+            double  _mean;
+            double  _m2;  // sum of squared deviations from the mean
+        public:
+            Moments() : _n(0), _sum(0.0), _min(T()), _max(T()), _mean(0.0),
+                        _m2(0.0) { };
+
+            long    n() const       { return(_n); };
+            double  sum() const     { return(_sum); };
+            const T min() const     { return(_min); };
+            const T max() const     { return(_max); };
+            double  mean() const    { return(_mean); };
+            //! sample variance if sample, else population variance
+            double  var(bool sample = true) const
+            { return(_m2 / (_n - (sample ? 1 : 0))); };
+
+            void
+            add(const T& x)
+            {
+                const double d = static_cast<double>(x);
+                if (_n == 0) { _min = _max = x; }
+                else { _min = Min(_min, x); _max = Max(_max, x); }
+                ++_n;
+                _sum += d;
+                const double delta = d - _mean;
+                _mean += delta / _n;
+                _m2 += delta * (d - _mean);
+            };
+
+            /*! Add n values at once: sum, minimum and maximum in one loop,
+                then squared deviations from the mean of these values in a
+                second over them while they are still in cache, then merge()
+                the result.  Sums are kept in four lanes, which removes the
+                dependence of each addition on the last so that the loops
+                can be vectorised.
+             */
+            void
+            add(const T* x, const size_t n)
+            {
+                if (n == 0) return;
+                Moments b;
+                b._n = n;
+                b._min = b._max = x[0];
+                double s[4] = { 0.0, 0.0, 0.0, 0.0 };
+                size_t i = 0;
+                for ( ; i + 4 <= n; i += 4) {
+                    for (int l = 0; l < 4; ++l) {
+                        s[l] += static_cast<double>(x[i + l]);
+                        b._min = Min(b._min, x[i + l]);
+                        b._max = Max(b._max, x[i + l]);
+                    }
+                }
+                for ( ; i < n; ++i) {
+                    s[0] += static_cast<double>(x[i]);
+                    b._min = Min(b._min, x[i]);
+                    b._max = Max(b._max, x[i]);
+                }
+                b._sum = (s[0] + s[1]) + (s[2] + s[3]);
+                b._mean = b._sum / n;
+                double m2[4] = { 0.0, 0.0, 0.0, 0.0 };
+                for (i = 0; i + 4 <= n; i += 4) {
+                    for (int l = 0; l < 4; ++l) {
+                        const double d = static_cast<double>(x[i + l]) - b._mean;
+                        m2[l] += d * d;
+                    }
+                }
+                for ( ; i < n; ++i) {
+                    const double d = static_cast<double>(x[i]) - b._mean;
+                    m2[0] += d * d;
+                }
+                b._m2 = (m2[0] + m2[1]) + (m2[2] + m2[3]);
+                merge(b);
+            };
+
+            void
+            merge(const Moments& o)
+            {
+                if (o._n == 0) return;
+                if (_n == 0) { *this = o; return; }
+                const double n = static_cast<double>(_n + o._n);
+                const double delta = o._mean - _mean;
+                _m2 += o._m2 + delta * delta * (static_cast<double>(_n) * o._n / n);
+                _mean += delta * (o._n / n);
+                _n += o._n;
+                _sum += o._sum;
+                _min = Min(_min, o._min);
+                _max = Max(_max, o._max);
+            };
+    };
+
+    // Moments of a view, a block at a time, gathering the values of an
+    // indexed view into a buffer
+    template<class T>
+    inline void
+    SummarizePart(const VectorView<T> Vec, Moments<T>* ans)
+    {
+        const size_t block = 1024;
+        std::vector<T> buf;
+        for (size_t first = 0; first < Vec.size(); first += block) {
+            const size_t n = Min(block, Vec.size() - first);
+            if (Vec.contiguous()) {
+                ans->add(Vec.data() + first, n);
+            } else {
+                buf.resize(n);
+                for (size_t i = 0; i < n; ++i) buf[i] = Vec[first + i];
+                ans->add(&buf[0], n);
+            }
+        }
+    }
+
+    /*! @brief Count, sum, minimum, maximum, mean and variance of values in
+               vector of class T, in one pass.
+
+        @param  Vec     vector of class T.
+        @param  nt      number of threads (1), 0 for the number of hardware
+                        threads; each summarises part of Vec, and the
+                        parts are merged in order
+        @return         Moments<T> of Vec
+     */
+    template<class T>
+    inline const Moments<T>
+    Summarize(const VectorView<T>& Vec, unsigned nt)
+    {
+        // least values per thread worth starting a thread for
+        const size_t min_per_thread = size_t(1) << 16;
+        if (nt == 0) nt = std::thread::hardware_concurrency();
+        if (nt == 0) nt = 1;
+        if (nt > Vec.size() / min_per_thread) nt = Vec.size() / min_per_thread;
+        if (nt <= 1) {
+            Moments<T> ans;
+            SummarizePart(Vec, &ans);
+            return(ans);
+        }
+        std::vector<Moments<T> > Parts(nt);
+        std::vector<std::thread> threads;
+        for (unsigned t = 1; t < nt; ++t) {
+            size_t first = Vec.size() * t / nt, last = Vec.size() * (t + 1) / nt;
+            threads.push_back(std::thread(&SummarizePart<T>,
+                                          Vec.sub(first, last - first), &Parts[t]));
+        }
+        SummarizePart(Vec.sub(0, Vec.size() / nt), &Parts[0]);
+        for (size_t t = 0; t < threads.size(); ++t) threads[t].join();
+        for (unsigned t = 1; t < nt; ++t) Parts[0].merge(Parts[t]);
+        return(Parts[0]);
+    }
+
+    template<class T>
+    inline const Moments<T>
+    Summarize(const std::vector<T>& Vec, unsigned nt)
+    { return(Summarize(VectorView<T>(Vec), nt)); }
+
     /*! @brief Construct map of runs of unique values in a vector,
                in order.
 
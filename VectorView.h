@@ -0,0 +1,81 @@
+#ifndef VECTORVIEW_H
+#define VECTORVIEW_H
+
+#include <vector>
+#include <cstddef>
+#include <cassert>
+
+/*! @class VectorView
+
+    @brief Read-only view of values held elsewhere, without copying them.
+
+    A view is either a contiguous range of values, such as all or part of a
+    std::vector, or a column of values read through a list of indices into
+    it, such as the lengths of the runs of one item in SequenceRuns.  Either
+    way element i is view[i] and there are size() of them.  A view holds
+    only pointers, so it is cheap to pass by value, and is valid only as
+    long as the values and indices it points to are neither changed in size
+    nor destroyed.
+
+    VectorUtility and Histogram take views wherever they take vectors.
+ */
+template<class T>
+class VectorView {
+
+    private:
+
+        const T*        _data;
+        const long*     _index;  // 0 for a contiguous view
+        size_t          _size;
+
+    public:
+
+        typedef T   value_type;
+
+        VectorView() : _data(0), _index(0), _size(0) { };
+
+        //! View of n contiguous values from data
+        VectorView(const T* data, const size_t n)
+            : _data(data), _index(0), _size(n) { };
+
+        //! View of all of Vec
+        VectorView(const std::vector<T>& Vec)
+            : _data(Vec.empty() ? 0 : &Vec[0]), _index(0), _size(Vec.size()) { };
+
+        //! View of data[index[0]], data[index[1]], ... data[index[n - 1]]
+        VectorView(const T* data, const long* index, const size_t n)
+            : _data(data), _index(index), _size(n) { };
+
+        size_t      size() const        { return(_size); };
+        bool        empty() const       { return(_size == 0); };
+        //! whether the values are contiguous, from data()
+        bool        contiguous() const  { return(_index == 0); };
+        const T*    data() const        { return(_index ? 0 : _data); };
+
+        const T&
+        operator[](const size_t i) const
+        {
+            assert(i < _size);
+            return(_index ? _data[_index[i]] : _data[i]);
+        };
+
+        //! View of n values from value first of this one
+        VectorView
+        sub(const size_t first, const size_t n) const
+        {
+            assert(first + n <= _size);
+            return(_index ? VectorView(_data, _index + first, n)
+                          : VectorView(_data + first, n));
+        };
+
+        //! Copy of the values, for the rare consumer that needs its own
+        std::vector<T>
+        to_vector() const
+        {
+            std::vector<T> ans(_size);
+            for (size_t i = 0; i < _size; ++i) ans[i] = (*this)[i];
+            return(ans);
+        };
+};
+
+#endif // VECTORVIEW_H
@@ -0,0 +1,119 @@
+#ifndef WORKSTEALING_H
+#define WORKSTEALING_H
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <functional>
+
+/*! @class WorkStealing
+
+    @brief Run numbered tasks across a pool of threads, with work stealing.
+
+    Tasks 0 .. n-1 are dealt out in contiguous blocks, one block to each
+    thread's own deque.  A thread takes its next task from the back of its
+    own deque, and when that is empty steals from the front of another
+    thread's, trying each in turn starting from its neighbour.  Tasks of
+    similar cost tend to be numbered together, as replicates of one grid
+    point are in Sweep, so the threads that drew cheap blocks finish early
+    and then take over the far end of the expensive blocks.
+
+    Each deque has its own mutex.  Tasks are coarse, whole simulations, so
+    the locking costs nothing measurable.  The task function is called as
+    f(task, thread) from several threads at once.
+ */
+class WorkStealing {
+
+    private:
+
+        struct TaskDeque {
+            std::mutex          lock;
+            std::deque<long>    tasks;
+        };
+
+        std::vector<TaskDeque>  Deques;
+        long                    _num_steals;
+        std::mutex              _steals_lock;
+
+        bool
+        pop_own(const unsigned t, long& task)
+        {
+            std::lock_guard<std::mutex> g(Deques[t].lock);
+            if (Deques[t].tasks.empty()) return(false);
+            task = Deques[t].tasks.back();
+            Deques[t].tasks.pop_back();
+            return(true);
+        };
+
+        bool
+        steal(const unsigned t, long& task)
+        {
+            const unsigned nt = Deques.size();
+            for (unsigned i = 1; i < nt; ++i) {
+                TaskDeque& victim = Deques[(t + i) % nt];
+                std::lock_guard<std::mutex> g(victim.lock);
+                if (victim.tasks.empty()) continue;
+                task = victim.tasks.front();
+                victim.tasks.pop_front();
+                return(true);
+            }
+            return(false);
+        };
+
+        template<class F>
+        void
+        worker(F& f, const unsigned t)
+        {
+            long task, steals = 0;
+            for (;;) {
+                if (pop_own(t, task)) { f(task, t); continue; }
+                // no task is ever added, so nothing left to steal means done
+                if (! steal(t, task)) break;
+                ++steals;
+                f(task, t);
+            }
+            std::lock_guard<std::mutex> g(_steals_lock);
+            _num_steals += steals;
+        };
+
+    public:
+
+        WorkStealing() : _num_steals(0) { };
+
+        //! Number of tasks stolen during the last run()
+        long    num_steals() const  { return(_num_steals); };
+
+        /*! Run tasks 0 .. n-1
+
+            @param n    number of tasks
+            @param nt   number of threads, 0 for the number of hardware threads
+            @param f    task function, f(long task, unsigned thread)
+         */
+        template<class F>
+        void
+        run(const long n, unsigned nt, F f)
+        {
+            if (nt == 0) nt = std::thread::hardware_concurrency();
+            if (nt == 0) nt = 1;
+            if (static_cast<long>(nt) > n) nt = (n > 0) ? n : 1;
+            std::vector<TaskDeque>(nt).swap(Deques);
+            _num_steals = 0;
+            // own tasks are taken from the back, so deal each block in
+            // reverse to start every thread at the front of its block
+            for (unsigned t = 0; t < nt; ++t) {
+                long first = n * t / nt, last = n * (t + 1) / nt;
+                for (long i = last - 1; i >= first; --i)
+                    Deques[t].tasks.push_back(i);
+            }
+            std::vector<std::thread> threads;
+            for (unsigned t = 1; t < nt; ++t)
+                threads.push_back(std::thread(&WorkStealing::worker<F>, this,
+                                              std::ref(f), t));
+            worker(f, 0);  // the calling thread works too
+            for (size_t t = 0; t < threads.size(); ++t) threads[t].join();
+        };
+};
+
+#endif // WORKSTEALING_H
+
@@ -1,10 +1,50 @@
 #include "GC.h"
 #include "Chromosome.h"
 #include "SequenceRuns.h"
+#include "Replicates.h"
+#include "Sweep.h"
 
 typedef long Scalar;
 
-int main () {
+// One replicate: ticks, mutations and final heterozygosity after 40 breaks
+
+struct ReplicateResult {
+    long ticks, mutations, heterozygous;
+    ReplicateResult() : ticks(0), mutations(0), heterozygous(0) { };
+};
+
+ReplicateResult
+replicate(Chromosome& C, long r)
+{
+    C.init(1000);
+    C.set_debug_repair(0);
+    C.set_mu(0.0000001);
+    C.set_c(0.000001);
+    C.set_heterozygosity(0.4);
+    long num_events = 40;
+    while (num_events > 0) {
+        C.step();
+        if (C.get_did_break()) { --num_events; }
+        C.repair1();
+    }
+    ReplicateResult ans;
+    ans.ticks = C.get_tick();
+    ans.mutations = C.number_mutations();
+    ans.heterozygous = C.number_heterozygous();
+    return(ans);
+}
+
+// chrom-gc grid_file [num_threads] runs a parameter sweep, see Sweep.h,
+// and prints its table; without arguments, run the demonstration below.
+
+int main (int argc, char* argv[]) {
+    if (argc > 1) {
+        Sweep S;
+        S.load_grid(argv[1]);
+        S.run(argc > 2 ? atoi(argv[2]) : 0);
+        S.print_table(std::cout);
+        return(0);
+    }
     Chromosome C(1000);
     C.set_mu(0.0000001);
     C.set_c(0.000001);
@@ -14,13 +54,22 @@ int main () {
     C.print_stats();
     long num_events = 40;
     while (num_events > 0) {
-        C.mutate();
-        C.dsbreak();
+        C.step();  // or, one tick at a time, C.mutate(); C.dsbreak();
         if (C.get_did_break()) { --num_events; }
         C.repair1();
     }
     std::cout << std::endl << "num mutations = " << C.number_mutations()
-        << "  num dsbreaks = " << C.number_dsbreaks() << std::endl;
+        << "  num dsbreaks = " << C.number_dsbreaks()
+        << "  num ticks = " << C.get_tick() << std::endl;
+
+    Replicates<ReplicateResult> R(8);
+    const std::vector<ReplicateResult>& res = R.run(replicate);
+    std::cout << std::endl << "replicate\tticks\tmutations\theterozygous" 
+        << std::endl;
+    for (size_t r = 0; r < res.size(); ++r)
+        std::cout << r << "\t" << res[r].ticks << "\t" << res[r].mutations
+            << "\t" << res[r].heterozygous << std::endl;
+
 //    for (long i = 0; i < 1000000000; ++i) {
 //        C.mutate();
 //    }